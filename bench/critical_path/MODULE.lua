@@ -0,0 +1,5 @@
+return {
+    name = 'critical_path',
+    version = 1,
+    deps = {},
+}
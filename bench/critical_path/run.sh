@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+
+# Benchmarks the ordering of ninja build statements. Builds this workspace from
+# scratch twice with 4 threads: first without any build history, then with the
+# step durations recorded in `.ninja_log` by the first build.
+#
+# Usage: YABT=path/to/yabt ./run.sh
+
+set -e
+
+YABT="$(realpath "${YABT:-yabt}")"
+BENCH_DIR="$(dirname "$(realpath "$0")")"
+WS_DIR="$(mktemp -d)"
+trap 'rm -rf "$WS_DIR"' EXIT
+
+# The root module of a workspace must be a git repository
+cp -r "$BENCH_DIR/MODULE.lua" "$BENCH_DIR/src" "$WS_DIR"
+cd "$WS_DIR"
+git init -q .
+git add .
+git -c user.name=bench -c user.email=bench@localhost commit -q -m bench
+
+timed_build() {
+    local start end
+    start=$(date +%s%N)
+    "$YABT" build --threads=4 '//critical_path/.*' > /dev/null
+    end=$(date +%s%N)
+    echo "$(( (end - start) / 1000000 )) ms"
+}
+
+echo "Without history: $(timed_build)"
+
+# Remove the outputs, but keep the build log
+find BUILD -type f ! -name .ninja_log -delete
+
+echo "With history:    $(timed_build)"
+"$YABT" analyze --top 3
@@ -0,0 +1,33 @@
+-- A chain of dependent steps competing with many short independent steps.
+-- Started last, the chain alone makes the build take twice as long as needed.
+
+local NUM_SHORT_STEPS = 12
+local CHAIN_LENGTH = 4
+
+local function sleep_step(ctx, output, inputs)
+    ctx.add_build_step {
+        outs = { output },
+        ins = inputs,
+        cmd = 'sleep 1 && touch ' .. output:absolute(),
+        descr = 'SLEEP ' .. output:relative(),
+    }
+end
+
+targets.Short = {
+    build = function(_, ctx)
+        for i = 1, NUM_SHORT_STEPS do
+            sleep_step(ctx, out('short' .. i), {})
+        end
+    end,
+}
+
+targets.Chain = {
+    build = function(_, ctx)
+        local previous = {}
+        for i = 1, CHAIN_LENGTH do
+            local output = out('chain' .. i)
+            sleep_step(ctx, output, previous)
+            previous = { output }
+        end
+    end,
+}
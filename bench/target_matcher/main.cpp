@@ -0,0 +1,85 @@
+// Matches 100k targets against a few patterns, with TargetMatcher and with the
+// previous loop running every std::regex against every target.
+
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/build/target_matcher.h"
+
+using yabt::build::TargetMatcher;
+
+namespace {
+
+constexpr size_t NUM_TARGETS = 100000;
+
+std::vector<std::string>
+match_with_regex(const std::vector<std::string_view> &patterns,
+                 const std::vector<std::string> &targets) {
+  std::vector<std::regex> regexes;
+  for (const std::string_view pattern : patterns) {
+    regexes.emplace_back(std::string{pattern});
+  }
+
+  std::vector<std::string> matched;
+  for (const std::string &target : targets) {
+    for (const std::regex &regex : regexes) {
+      if (std::regex_match(target, regex)) {
+        matched.push_back(target);
+        break;
+      }
+    }
+  }
+  return matched;
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> targets;
+  for (size_t i = 0; i < NUM_TARGETS; i++) {
+    targets.push_back(
+        std::format("//mod{}/path{}/Target{}", i % 10, i % 100, i));
+  }
+  const std::vector<std::string_view> patterns{
+      "//mod1/.*", "//mod2/path12/...", "//mod3/path3/Target[0-9]+3",
+      "//mod4/path4/Target4"};
+  // Same patterns, in the regex-only syntax
+  const std::vector<std::string_view> regex_patterns{
+      "//mod1/.*", "//mod2/path12/.*", "//mod3/path3/Target[0-9]+3",
+      "//mod4/path4/Target4"};
+
+  using Clock = std::chrono::steady_clock;
+  const auto matcher_start = Clock::now();
+  auto matcher = TargetMatcher::compile(patterns);
+  if (matcher.is_error()) {
+    std::cerr << matcher.error_value() << '\n';
+    return EXIT_FAILURE;
+  }
+  const std::vector<std::string> matched = matcher.ok_value().match(targets);
+  const auto matcher_end = Clock::now();
+  const std::vector<std::string> expected =
+      match_with_regex(regex_patterns, targets);
+  const auto regex_end = Clock::now();
+
+  if (matched != expected) {
+    std::cerr << "TargetMatcher and std::regex disagree\n";
+    return EXIT_FAILURE;
+  }
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  std::cout << std::format(
+      "{} targets, {} matched\n"
+      "TargetMatcher: {} us\n"
+      "std::regex:    {} us\n",
+      targets.size(), matched.size(),
+      duration_cast<microseconds>(matcher_end - matcher_start).count(),
+      duration_cast<microseconds>(regex_end - matcher_end).count());
+  return EXIT_SUCCESS;
+}
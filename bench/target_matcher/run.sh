@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+
+# Benchmarks target pattern matching. Builds main.cpp with the same
+# optimization level as yabt itself, and runs it.
+#
+# Usage: CXX=path/to/c++ ./run.sh
+
+set -e
+
+CXX="${CXX:-g++}"
+BENCH_DIR="$(dirname "$(realpath "$0")")"
+ROOT_DIR="$(realpath "$BENCH_DIR/../..")"
+OUT_DIR="$(mktemp -d)"
+trap 'rm -rf "$OUT_DIR"' EXIT
+
+"$CXX" -std=c++20 -O2 -I"$ROOT_DIR/include" \
+    "$BENCH_DIR/main.cpp" "$ROOT_DIR/src/yabt/build/target_matcher.cpp" \
+    -o "$OUT_DIR/target_matcher"
+"$OUT_DIR/target_matcher"
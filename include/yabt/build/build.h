@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -21,9 +22,28 @@ constexpr static std::string_view INIT_FILE_NAME = "INIT.lua";
 
 enum class PostBuildMode { None, Run, Test };
 
+enum class CompdbMode { None, Single, WithFragments };
+
+struct BuildOptions final {
+  int threads{0};
+  std::optional<std::filesystem::path> build_dir{};
+  CompdbMode compdb{CompdbMode::None};
+  // Prints where the build time went after ninja finishes
+  bool report{false};
+  // Time each run or test process gets before it is terminated, unless its
+  // target sets its own timeout
+  std::optional<std::chrono::seconds> timeout{};
+  // Number of tests running at the same time, 0 runs one per core
+  size_t test_jobs{0};
+  // Skips tests that passed before with the same executable and arguments
+  bool test_cache{true};
+  // Where to write the results of the tests, for CI systems
+  std::optional<std::filesystem::path> junit_report{};
+  std::optional<std::filesystem::path> json_report{};
+};
+
 [[nodiscard]] runtime::Result<void, std::string>
-execute_build(int threads, bool compdb,
-              const std::optional<std::filesystem::path> &requested_build_dir,
+execute_build(const BuildOptions &options,
               std::span<const std::string_view> target_patterns,
               PostBuildMode mode = PostBuildMode::None,
               std::span<const std::string_view> action_args = {});
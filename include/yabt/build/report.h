@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+#include "yabt/lua/context_lib.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::build {
+
+constexpr static size_t DEFAULT_REPORT_STEPS = 10;
+
+// Prints where the time of the last ninja run in `build_dir` went: the
+// critical path, the `top_steps` slowest steps and targets, and how well the
+// build was parallelized.
+[[nodiscard]] runtime::Result<void, std::string>
+report_build(const std::filesystem::path &build_dir,
+             const lua::ContextLib &contextlib, size_t top_steps) noexcept;
+
+} // namespace yabt::build
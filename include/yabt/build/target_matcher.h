@@ -0,0 +1,51 @@
+#pragma once
+
+#include <regex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::build {
+
+// Matches target specs against the patterns given in the command line.
+// Patterns are regular expressions matching the whole target spec, and
+// `//mod/path/...` selects every target under `//mod/path`. The common forms
+// (exact specs and literal prefixes) are resolved without using regular
+// expressions.
+class TargetMatcher final {
+public:
+  [[nodiscard]] static runtime::Result<TargetMatcher, std::string>
+  compile(std::span<const std::string_view> patterns) noexcept;
+
+  // Returns the targets matching any of the patterns, in the order they
+  // appear in `targets`, without duplicates.
+  [[nodiscard]] std::vector<std::string>
+  match(std::span<const std::string> targets) const noexcept;
+
+  [[nodiscard]] bool matches(std::string_view target) const noexcept;
+
+private:
+  TargetMatcher() noexcept;
+
+  // Node of a trie over the literal prefixes of the patterns
+  struct TrieNode final {
+    std::vector<std::pair<char, size_t>> children;
+    // Every target starting with the prefix of this node matches
+    bool matches_all{false};
+    // Indices of the regular expressions whose literal prefix ends here
+    std::vector<size_t> regexes;
+  };
+
+  [[nodiscard]] size_t insert_prefix(std::string_view prefix) noexcept;
+
+  std::unordered_set<std::string> m_exact;
+  std::vector<TrieNode> m_trie;
+  std::vector<std::regex> m_regexes;
+};
+
+} // namespace yabt::build
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::build {
+
+constexpr static std::string_view TEST_CACHE_DIR_NAME = "test_cache";
+
+// What a test depends on when it runs, as declared in the build graph
+struct TestInputs final {
+  std::span<const std::string> argv;
+  // Compared by content: the outputs of the target and the data files it
+  // declares. Directories are compared file by file.
+  std::vector<std::filesystem::path> files;
+  // Compared by size and modification time: the files built on the way to
+  // the outputs, like the shared libraries a test binary loads
+  std::vector<std::filesystem::path> built_files;
+};
+
+// Remembers which test invocations passed. An invocation is identified by its
+// argv, the environment of yabt, which tests inherit, and its TestInputs.
+class TestCache final {
+public:
+  explicit TestCache(std::filesystem::path dir) noexcept;
+
+  // Fails when the key would not cover everything the test reads, like an
+  // argument naming a file that is not one of its inputs
+  [[nodiscard]] runtime::Result<std::string, std::string>
+  key(const TestInputs &inputs) const noexcept;
+
+  [[nodiscard]] bool has_passed(std::string_view key) const noexcept;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  record_pass(std::string_view key, std::string_view target) const noexcept;
+
+private:
+  std::filesystem::path m_dir;
+};
+
+} // namespace yabt::build
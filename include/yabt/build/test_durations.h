@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::build {
+
+constexpr static std::string_view TEST_DURATIONS_FILE_NAME = "test_durations";
+
+// How long the test of each target took the last time it ran, adding up the
+// time of its shards.
+using TestDurations = std::map<std::string, std::chrono::milliseconds>;
+
+// A missing file has no durations
+[[nodiscard]] runtime::Result<TestDurations, std::string>
+load_test_durations(const std::filesystem::path &path) noexcept;
+
+[[nodiscard]] runtime::Result<void, std::string>
+save_test_durations(const std::filesystem::path &path,
+                    const TestDurations &durations) noexcept;
+
+} // namespace yabt::build
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+
+#include "yabt/process/process.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::build {
+
+// Outcome of running or testing a target
+struct ActionSummary final {
+  std::string target;
+  bool passed;
+  process::Process::ResourceUsage resource_usage;
+  // Skipped, since the same test passed before
+  bool cached{false};
+  size_t shards{1};
+  // How the process ended, like "exit code 1" or "timed out"
+  std::string exit_reason{};
+  // Captured output of the failed processes
+  std::string failure_output{};
+};
+
+// Describes how the process ended, for ActionSummary::exit_reason
+[[nodiscard]] std::string
+describe_exit(const process::Process::ProcessOutput &output) noexcept;
+
+// Reports in the JUnit XML format understood by most CI systems, with one
+// test case per target
+[[nodiscard]] runtime::Result<void, std::string>
+write_junit_report(const std::filesystem::path &path,
+                   std::span<const ActionSummary> summaries) noexcept;
+
+[[nodiscard]] runtime::Result<void, std::string>
+write_json_report(const std::filesystem::path &path,
+                  std::span<const ActionSummary> summaries) noexcept;
+
+} // namespace yabt::build
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "yabt/build/report.h"
+#include "yabt/cli/cli_parser.h"
+#include "yabt/cli/subcommand.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::cmd {
+
+class AnalyzeCommand final : public cli::SubcommandHandler {
+public:
+  AnalyzeCommand() noexcept = default;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  register_command(cli::CliParser &parser) noexcept;
+
+  [[nodiscard]] runtime::Result<void, std::string> handle_subcommand(
+      std::span<const std::string_view> unparsed_args) noexcept final;
+
+private:
+  std::optional<std::filesystem::path> m_build_dir{};
+  size_t m_top_steps{build::DEFAULT_REPORT_STEPS};
+};
+
+} // namespace yabt::cmd
@@ -6,6 +6,7 @@
 #include <string>
 #include <string_view>
 
+#include "yabt/build/build.h"
 #include "yabt/cli/cli_parser.h"
 #include "yabt/cli/subcommand.h"
 #include "yabt/runtime/result.h"
@@ -23,9 +24,7 @@ public:
       std::span<const std::string_view> unparsed_args) noexcept final;
 
 private:
-  int m_threads{0};
-  std::optional<std::filesystem::path> m_build_dir{};
-  bool m_compdb{false};
+  build::BuildOptions m_options{};
 };
 
 } // namespace yabt::cmd
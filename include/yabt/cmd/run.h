@@ -5,6 +5,7 @@
 #include <span>
 #include <string>
 
+#include "yabt/build/build.h"
 #include "yabt/cli/cli_parser.h"
 #include "yabt/cli/subcommand.h"
 #include "yabt/runtime/result.h"
@@ -22,8 +23,7 @@ public:
       std::span<const std::string_view> unparsed_args) noexcept final;
 
 private:
-  int m_threads{0};
-  std::optional<std::filesystem::path> m_build_dir{};
+  build::BuildOptions m_options{};
 };
 
 } // namespace yabt::cmd
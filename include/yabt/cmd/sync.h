@@ -18,6 +18,8 @@ public:
 
 private:
   workspace::SyncMode m_sync_mode{workspace::SyncMode::NORMAL};
+  size_t m_jobs{workspace::DEFAULT_SYNC_JOBS};
+  std::optional<std::filesystem::path> m_cache_dir;
 };
 
 } // namespace yabt::cmd
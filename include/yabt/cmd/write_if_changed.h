@@ -0,0 +1,21 @@
+#pragma once
+
+#include "yabt/cli/cli_parser.h"
+#include "yabt/cli/subcommand.h"
+
+namespace yabt::cmd {
+
+class WriteIfChangedCommand final : public cli::SubcommandHandler {
+public:
+  WriteIfChangedCommand() noexcept = default;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  register_command(cli::CliParser &parser) noexcept;
+
+  [[nodiscard]] runtime::Result<void, std::string> handle_subcommand(
+      std::span<const std::string_view> unparsed_args) noexcept final;
+
+private:
+};
+
+} // namespace yabt::cmd
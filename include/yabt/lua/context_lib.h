@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <set>
 #include <span>
@@ -49,6 +50,13 @@ public:
   std::vector<std::string> all_targets;
   std::map<std::string, int> run_fn_refs;  // target -> Lua registry reference
   std::map<std::string, int> test_fn_refs; // target -> Lua registry reference
+  std::map<std::string, std::string> output_targets; // output -> target
+  std::map<std::string, std::chrono::milliseconds> target_timeouts;
+  // Targets whose test can be split in shards, following the gtest protocol
+  std::set<std::string> shardable_targets;
+  // Files the test of a target reads besides its outputs, for targets that
+  // declare them. Tests of other targets are never cached.
+  std::map<std::string, std::vector<std::string>> target_runtime_inputs;
 
   lua_State *state;
   std::string current_target;
@@ -299,6 +299,15 @@ parse_with_spec(lua_State *const L, LuaUserData<OutPath>);
 #define _APPLY_OP_VA_ARGS5(op, fixed_arg, first, ...)                          \
   _APPLY_OP_VA_ARGS1(op, fixed_arg, first)                                     \
   _APPLY_OP_VA_ARGS4(op, fixed_arg, __VA_ARGS__)
+#define _APPLY_OP_VA_ARGS6(op, fixed_arg, first, ...)                          \
+  _APPLY_OP_VA_ARGS1(op, fixed_arg, first)                                     \
+  _APPLY_OP_VA_ARGS5(op, fixed_arg, __VA_ARGS__)
+#define _APPLY_OP_VA_ARGS7(op, fixed_arg, first, ...)                          \
+  _APPLY_OP_VA_ARGS1(op, fixed_arg, first)                                     \
+  _APPLY_OP_VA_ARGS6(op, fixed_arg, __VA_ARGS__)
+#define _APPLY_OP_VA_ARGS8(op, fixed_arg, first, ...)                          \
+  _APPLY_OP_VA_ARGS1(op, fixed_arg, first)                                     \
+  _APPLY_OP_VA_ARGS7(op, fixed_arg, __VA_ARGS__)
 
 #define _APPLY_OP_VA_ARGS_IMPL(nargs, op, fixed_arg, ...)                      \
   _JOIN(_APPLY_OP_VA_ARGS, nargs)(op, fixed_arg, __VA_ARGS__)
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "yabt/module/module.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::module {
+
+constexpr static std::string_view ARCHIVE_CACHE_DIR_NAME = "archives";
+// Written in the module directory once the archive is fully extracted
+constexpr static std::string_view ARCHIVE_MARKER_FILE_NAME = ".yabt_archive";
+
+// A module extracted from a tar or zip archive, identified by the SHA-256 of
+// the archive. Archives have no history, so their only revision is the hash.
+class ArchiveModule final : public Module {
+public:
+  // Downloads the archive into a content-addressed cache, unless it is
+  // already there, and extracts it into the module directory. Archives with
+  // a single top-level directory are extracted without it. The cache is
+  // shared in cache_dir when given, and kept next to the modules otherwise.
+  [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
+  open_or_fetch_module(
+      const std::filesystem::path &mod_dir, std::string_view mod_url,
+      std::string_view mod_hash,
+      const std::optional<std::filesystem::path> &cache_dir) noexcept;
+
+  [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
+  open(std::filesystem::path mod_dir) noexcept;
+
+  [[nodiscard]] std::string name() const noexcept final;
+
+  [[nodiscard]] std::filesystem::path disk_path() const noexcept final;
+
+  [[nodiscard]] bool has_revisions() const noexcept final;
+
+  [[nodiscard]] runtime::Result<std::string, std::string>
+  head() const noexcept final;
+
+  [[nodiscard]] runtime::Result<void, std::string> fetch() const noexcept final;
+
+  [[nodiscard]] runtime::Result<bool, std::string>
+  has_revision(std::string_view revision) const noexcept final;
+
+  [[nodiscard]] runtime::Result<bool, std::string>
+  is_ancestor(std::string_view ancestor,
+              std::string_view revision) const noexcept final;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  checkout(std::string_view revision) const noexcept final;
+
+  ArchiveModule(const ArchiveModule &) noexcept = default;
+  ArchiveModule(ArchiveModule &&) noexcept = default;
+  ArchiveModule &operator=(const ArchiveModule &) noexcept = default;
+  ArchiveModule &operator=(ArchiveModule &&) noexcept = default;
+
+  ~ArchiveModule() noexcept final = default;
+
+private:
+  ArchiveModule(const std::filesystem::path &, std::string hash) noexcept;
+
+  std::filesystem::path m_path;
+  std::string m_hash;
+};
+
+} // namespace yabt::module
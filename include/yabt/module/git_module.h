@@ -2,6 +2,8 @@
 
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
 
 #include "yabt/module/module.h"
@@ -9,12 +11,17 @@
 
 namespace yabt::module {
 
+constexpr static std::string_view GIT_CACHE_DIR_NAME = "git";
+
 class GitModule final : public Module {
 public:
+  // With a cache directory, the module borrows the objects of a mirror of its
+  // url kept in the cache, which all the workspaces of the user share
   [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
-  open_or_fetch_module(const std::filesystem::path &mod_dir,
-                       std::string_view mod_url, std::string_view mod_type,
-                       std::string_view mod_hash) noexcept;
+  open_or_fetch_module(
+      const std::filesystem::path &mod_dir, std::string_view mod_url,
+      std::string_view mod_type, std::string_view mod_hash,
+      const std::optional<std::filesystem::path> &cache_dir) noexcept;
 
   [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
   open(std::filesystem::path mod_dir) noexcept;
@@ -23,11 +30,16 @@ public:
 
   [[nodiscard]] std::filesystem::path disk_path() const noexcept final;
 
+  [[nodiscard]] bool has_revisions() const noexcept final;
+
   [[nodiscard]] runtime::Result<std::string, std::string>
   head() const noexcept final;
 
   [[nodiscard]] runtime::Result<void, std::string> fetch() const noexcept final;
 
+  [[nodiscard]] runtime::Result<bool, std::string>
+  has_revision(std::string_view revision) const noexcept final;
+
   [[nodiscard]] runtime::Result<bool, std::string>
   is_ancestor(std::string_view ancestor,
               std::string_view revision) const noexcept final;
@@ -43,9 +55,13 @@ public:
   ~GitModule() noexcept final = default;
 
 private:
-  GitModule(const std::filesystem::path &) noexcept;
+  GitModule(const std::filesystem::path &,
+            std::optional<std::filesystem::path> cache_dir = std::nullopt,
+            std::string_view url = "") noexcept;
 
   std::filesystem::path m_path;
+  std::optional<std::filesystem::path> m_cache_dir;
+  std::string m_url;
 };
 
 } // namespace yabt::module
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "yabt/module/module.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::module {
+
+// A module used in place from a directory of the filesystem, through a
+// symlink in the directory of dependencies. It has no revisions: sync never
+// fetches nor checks it out.
+class LocalModule final : public Module {
+public:
+  // Links the module directory to the path in the url. Relative paths are
+  // relative to the workspace root, the parent of the dependencies directory.
+  // Those of other modules are made absolute by resolve_url beforehand.
+  [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
+  open_or_fetch_module(const std::filesystem::path &mod_dir,
+                       std::string_view mod_url) noexcept;
+
+  [[nodiscard]] static runtime::Result<std::unique_ptr<Module>, std::string>
+  open(std::filesystem::path mod_dir) noexcept;
+
+  [[nodiscard]] std::string name() const noexcept final;
+
+  [[nodiscard]] std::filesystem::path disk_path() const noexcept final;
+
+  [[nodiscard]] bool has_revisions() const noexcept final;
+
+  [[nodiscard]] runtime::Result<std::string, std::string>
+  head() const noexcept final;
+
+  [[nodiscard]] runtime::Result<void, std::string> fetch() const noexcept final;
+
+  [[nodiscard]] runtime::Result<bool, std::string>
+  has_revision(std::string_view revision) const noexcept final;
+
+  [[nodiscard]] runtime::Result<bool, std::string>
+  is_ancestor(std::string_view ancestor,
+              std::string_view revision) const noexcept final;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  checkout(std::string_view revision) const noexcept final;
+
+  LocalModule(const LocalModule &) noexcept = default;
+  LocalModule(LocalModule &&) noexcept = default;
+  LocalModule &operator=(const LocalModule &) noexcept = default;
+  LocalModule &operator=(LocalModule &&) noexcept = default;
+
+  ~LocalModule() noexcept final = default;
+
+private:
+  LocalModule(const std::filesystem::path &) noexcept;
+
+  std::filesystem::path m_path;
+};
+
+} // namespace yabt::module
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::module {
+
+constexpr static std::string_view LOCK_FILE_NAME = "MODULE.lock";
+constexpr static int LOCK_FILE_VERSION = 1;
+
+// A module of the workspace, resolved to the hash it was synced at
+struct LockedModule final {
+  std::string url;
+  std::string hash;
+  std::string type;
+};
+
+using LockedModuleMap = std::map<std::string, LockedModule>;
+
+// Every transitive dependency of a workspace, as resolved by the last sync.
+// Written in lua, like module files, so that it is parsed the same way.
+struct LockFile final {
+  int version;
+  // SHA-256 of the root module file the lock was resolved from
+  std::string module_file_hash;
+  LockedModuleMap modules;
+
+  [[nodiscard]] static runtime::Result<LockFile, std::string>
+  load_lock_file(std::filesystem::path path) noexcept;
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  write_lock_file(const std::filesystem::path &path) const noexcept;
+};
+
+} // namespace yabt::module
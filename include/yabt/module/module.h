@@ -19,12 +19,20 @@ public:
 
   [[nodiscard]] virtual std::filesystem::path disk_path() const noexcept = 0;
 
+  // Whether the module has revisions to fetch and check out. Modules without
+  // them are used as they are.
+  [[nodiscard]] virtual bool has_revisions() const noexcept = 0;
+
   [[nodiscard]] virtual runtime::Result<std::string, std::string>
   head() const noexcept = 0;
 
   [[nodiscard]] virtual runtime::Result<void, std::string>
   fetch() const noexcept = 0;
 
+  // Whether the revision is available locally, without fetching
+  [[nodiscard]] virtual runtime::Result<bool, std::string>
+  has_revision(std::string_view revision) const noexcept = 0;
+
   [[nodiscard]] virtual runtime::Result<bool, std::string>
   is_ancestor(std::string_view ancestor,
               std::string_view revision) const noexcept = 0;
@@ -38,11 +46,19 @@ public:
 };
 
 [[nodiscard]] runtime::Result<std::unique_ptr<Module>, std::string>
-open_or_fetch_module(const std::filesystem::path &mod_dir,
-                     std::string_view mod_url, std::string_view mod_type,
-                     std::string_view mod_hash);
+open_or_fetch_module(
+    const std::filesystem::path &mod_dir, std::string_view mod_url,
+    std::string_view mod_type, std::string_view mod_hash,
+    const std::optional<std::filesystem::path> &cache_dir = std::nullopt);
 
 [[nodiscard]] runtime::Result<std::unique_ptr<Module>, std::string>
 open_module(const std::filesystem::path &mod_dir);
 
+// Returns the url of a dependency declared by the module at mod_dir, as
+// open_or_fetch_module expects it. Relative paths of local dependencies are
+// relative to the declaring module, and are made absolute.
+[[nodiscard]] std::string resolve_url(const std::filesystem::path &mod_dir,
+                                      std::string_view mod_url,
+                                      std::string_view mod_type) noexcept;
+
 } // namespace yabt::module
@@ -15,6 +15,7 @@ struct BuildRule {
   std::string descr;
   std::map<std::string, std::string> variables;
   bool compdb; // whether the rule should be part of the compilation database
+  bool restat; // whether ninja should re-stat outputs after running the rule
 };
 
 } // namespace yabt::ninja
@@ -27,7 +28,8 @@ LUA_STRUCT_PARSE_SPEC_DEF(                   //
     (std::string, cmd),                      //
     (std::string, descr),                    //
     (::yabt::ninja::VariableMap, variables), //
-    (bool, compdb)                           //
+    (bool, compdb),                          //
+    (bool, restat)                           //
 );
 
 } // namespace yabt::lua
@@ -14,6 +14,7 @@ struct BuildStep {
   std::vector<lua::Path> ins;
   std::string cmd;
   std::string descr;
+  bool restat; // whether ninja should re-stat outputs after running the step
 };
 
 [[nodiscard]] inline bool operator==(const BuildStep &lhs,
@@ -44,6 +45,10 @@ struct BuildStep {
     return false;
   }
 
+  if (lhs.restat != rhs.restat) {
+    return false;
+  }
+
   return true;
 }
 
@@ -116,7 +121,8 @@ LUA_STRUCT_PARSE_SPEC_DEF(             //
     (std::vector<lua::OutPath>, outs), //
     (std::vector<lua::Path>, ins),     //
     (std::string, cmd),                //
-    (std::string, descr)               //
+    (std::string, descr),              //
+    (bool, restat)                     //
 );
 
 LUA_STRUCT_PARSE_SPEC_DEF(                  //
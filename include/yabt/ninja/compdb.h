@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "yabt/ninja/build_rule.h"
+#include "yabt/ninja/build_step.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::ninja {
+
+// Expands the command of a rule for the given build step, following the
+// variable lookup rules of ninja ($in, $out, build step variables and rule
+// variables).
+[[nodiscard]] std::string expand_command(const BuildRule &rule,
+                                         const BuildStepWithRule &step);
+
+// Per-directory compilation databases, each containing the entries of the
+// sources in one directory.
+struct CompdbFragments final {
+  // Fragments mirror the directory layout below this path
+  std::filesystem::path source_root;
+  // Directory where the fragments are written
+  std::filesystem::path output_dir;
+};
+
+// Generates the compilation database for all build steps using a rule with
+// `compdb` set. An index with the hash of every entry is kept next to the
+// database, and another one next to the fragments. Files are only rewritten
+// when their entries change.
+[[nodiscard]] runtime::Result<void, std::string> save_compdb_file(
+    const std::filesystem::path &compdb_path,
+    const std::filesystem::path &build_dir,
+    const std::map<std::string, BuildRule> &build_rules,
+    std::span<const BuildStepWithRule> build_steps_with_rule,
+    const std::optional<CompdbFragments> &fragments = std::nullopt) noexcept;
+
+} // namespace yabt::ninja
@@ -7,14 +7,19 @@
 
 #include "yabt/ninja/build_rule.h"
 #include "yabt/ninja/build_step.h"
+#include "yabt/ninja/ninja_log.h"
 #include "yabt/runtime/result.h"
 
 namespace yabt::ninja {
 
+// Writes the ninja manifest. When `step_durations` is known from previous
+// builds, build statements are sorted so that the ones heading the longest
+// chains of dependent steps come first, which makes ninja start them first.
 [[nodiscard]] runtime::Result<void, std::string> save_ninja_file(
     const std::filesystem::path ninja_filepath,
     const std::map<std::string, BuildRule> &build_rules,
     std::span<const BuildStep> build_steps,
-    std::span<const BuildStepWithRule> build_steps_with_rule) noexcept;
+    std::span<const BuildStepWithRule> build_steps_with_rule,
+    const StepDurations &step_durations = {}) noexcept;
 
 }
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::ninja {
+
+constexpr static std::string_view NINJA_LOG_FILE_NAME = ".ninja_log";
+
+// A build step executed by ninja. Times are in milliseconds since the start
+// of the run.
+struct NinjaLogEntry final {
+  uint64_t start_ms;
+  uint64_t end_ms;
+  std::string output;
+};
+
+// Duration in milliseconds of the last execution of the step producing each
+// output
+using StepDurations = std::map<std::string, uint64_t>;
+
+// Loads the entries of the last ninja run from the given `.ninja_log`.
+[[nodiscard]] runtime::Result<std::vector<NinjaLogEntry>, std::string>
+load_ninja_log(const std::filesystem::path &log_path) noexcept;
+
+// Loads the most recent duration of every output in the given `.ninja_log`,
+// including outputs that were not rebuilt in the last run.
+[[nodiscard]] runtime::Result<StepDurations, std::string>
+load_step_durations(const std::filesystem::path &log_path) noexcept;
+
+} // namespace yabt::ninja
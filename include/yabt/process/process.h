@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <optional>
 #include <span>
 #include <string>
@@ -50,10 +52,36 @@ public:
 
   using ExitReason = std::variant<NormalExit, UnhandledSignal>;
 
+  struct ResourceUsage final {
+    std::chrono::microseconds wall_time;
+    std::chrono::microseconds user_time;
+    std::chrono::microseconds system_time;
+    // Peak resident set size of the process, in KiB
+    long max_rss_kib;
+
+    // Human readable one-line summary
+    [[nodiscard]] std::string summary() const noexcept;
+  };
+
+  enum class Stream { STDOUT, STDERR };
+
+  // Time a process gets to exit after SIGTERM before it is killed
+  constexpr static std::chrono::milliseconds KILL_GRACE_PERIOD{5000};
+
+  // Without pidfd support, exited processes are detected by polling
+  constexpr static std::chrono::milliseconds EXIT_POLL_INTERVAL{10};
+
+  // Receives each line of the captured output (without the trailing newline)
+  // as soon as the child writes it.
+  using LineCallback = std::function<void(Stream, std::string_view line)>;
+
   struct ProcessOutput final {
     std::optional<std::string> stdout;
     std::optional<std::string> stderr;
     ExitReason exit_reason;
+    ResourceUsage resource_usage;
+    // The process was terminated because it exceeded its timeout
+    bool timed_out{false};
 
     [[nodiscard]] runtime::Result<void, std::string> to_result() const noexcept;
   };
@@ -76,11 +104,58 @@ public:
 
   void set_cwd(const std::string_view path);
 
+  // Sets an environment variable for the process, on top of the environment of
+  // yabt.
+  void set_env(std::string_view name, std::string_view value);
+
+  // Streams the captured output to `callback` instead of collecting it in the
+  // ProcessOutput. Only has an effect when the output is captured.
+  void set_line_callback(LineCallback callback);
+
+  // Terminates the process once `timeout` elapses with SIGTERM and, after
+  // KILL_GRACE_PERIOD, SIGKILL. A captured process runs in its own process
+  // group, which receives the signals, so anything it started terminates too.
+  // Uncaptured processes stay in the foreground group to keep the terminal,
+  // and only the process itself is signaled.
+  void set_timeout(std::chrono::milliseconds timeout);
+
   [[nodiscard]] runtime::Result<void, std::string>
   start(bool capture_stdout = false) noexcept;
 
+  // Waits for the process to finish, collecting its output
   [[nodiscard]] ProcessOutput process_output() noexcept;
 
+  // Building blocks to drive several processes from a single event loop (see
+  // ProcessPool). Read the captured streams while they are readable, and call
+  // `finish` once both reached EOF and the process exited.
+
+  [[nodiscard]] int pid() const noexcept { return m_child_pid; }
+
+  // File descriptor of a captured stream, or -1 once it reached EOF or when
+  // the output is not captured.
+  [[nodiscard]] int output_fd(Stream stream) const noexcept;
+
+  // Reads the data available in the given stream. Returns false once the
+  // stream reaches EOF.
+  [[nodiscard]] bool read_output(Stream stream) noexcept;
+
+  // Reaps the process and returns its output. Blocks until it exits.
+  [[nodiscard]] ProcessOutput finish() noexcept;
+
+  // Milliseconds until `enforce_timeout` has to be called, or -1 when the
+  // process has no pending deadline.
+  [[nodiscard]] int ms_until_deadline() const noexcept;
+
+  // Signals the process group if its deadline passed.
+  void enforce_timeout() noexcept;
+
+  // Returns a file descriptor that becomes readable when the process exits,
+  // or -1 if the kernel does not support pidfds.
+  [[nodiscard]] int open_pidfd() const noexcept;
+
+  // Checks whether the process exited, without reaping it
+  [[nodiscard]] bool has_exited() const noexcept;
+
 private:
   enum class Status {
     CREATED,
@@ -91,13 +166,35 @@ private:
   std::string m_exe;
   std::vector<std::string> m_args;
   std::optional<std::string> m_cwd{};
+  std::vector<std::string> m_env{}; // NAME=VALUE overrides
   Status m_status{Status::CREATED};
   int m_child_pid{};
   int m_stdout_read_pipe{-1};
   int m_stderr_read_pipe{-1};
+  std::string m_stdout_buffer{};
+  std::string m_stderr_buffer{};
+  bool m_captured{false};
   int m_exit_code{};
+  std::chrono::steady_clock::time_point m_start_time{};
+  ResourceUsage m_resource_usage{};
+  LineCallback m_line_callback{};
+  std::optional<std::chrono::milliseconds> m_timeout{};
+  std::optional<std::chrono::steady_clock::time_point> m_deadline{};
+  bool m_timed_out{false};
+  bool m_own_group{false};
+  std::optional<size_t> m_interrupt_slot{};
 
   [[nodiscard]] ExitReason wait_completion() noexcept;
 };
 
+// Keeps yabt alive on SIGINT and SIGTERM until its children exit, forwarding
+// the signal to every running child. Children in their own process group (see
+// Process::set_timeout) get it as a group. Signals from the terminal are only
+// forwarded to those, the others are in the terminal's foreground group and
+// already received them.
+void forward_interrupts() noexcept;
+
+// Whether yabt received SIGINT or SIGTERM after `forward_interrupts`
+[[nodiscard]] bool interrupted() noexcept;
+
 } // namespace yabt::process
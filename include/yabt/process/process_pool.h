@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yabt/process/process.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::process {
+
+// Runs processes concurrently, at most `max_concurrency` at a time, from a
+// single-threaded event loop.
+class ProcessPool final {
+public:
+  // Receives the output of the process, or the error preventing it from
+  // starting. May submit new processes to the pool.
+  using CompletionCallback = std::function<void(
+      runtime::Result<Process::ProcessOutput, std::string> output)>;
+
+  explicit ProcessPool(size_t max_concurrency) noexcept;
+
+  ProcessPool(const ProcessPool &) = delete;
+  ProcessPool &operator=(const ProcessPool &) = delete;
+
+  ~ProcessPool() noexcept;
+
+  // Queues the process. It is started once a slot is free, processes with a
+  // higher priority first and in submission order otherwise.
+  void submit(std::unique_ptr<Process> process, bool capture_output,
+              CompletionCallback callback, int64_t priority = 0);
+
+  // Queues the process ahead of every pending one.
+  void submit_first(std::unique_ptr<Process> process, bool capture_output,
+                    CompletionCallback callback);
+
+  // Changes how many processes may run at a time. Running processes are left
+  // alone when it drops, new ones only start once enough of them finished.
+  void set_max_concurrency(size_t max_concurrency) noexcept;
+
+  // Runs the event loop until every submitted process completed.
+  [[nodiscard]] runtime::Result<void, std::string> run() noexcept;
+
+private:
+  struct Job;
+
+  // What an epoll event refers to
+  struct EventSource final {
+    Job *job;
+    enum class Kind { STDOUT, STDERR, EXIT } kind;
+  };
+
+  struct Job final {
+    std::unique_ptr<Process> process;
+    bool capture_output;
+    CompletionCallback callback;
+    int64_t priority{0};
+    int pidfd{-1};
+    bool exited{false};
+    std::array<EventSource, 3> sources{};
+  };
+
+  size_t m_max_concurrency;
+  int m_epoll_fd{-1};
+  std::deque<std::unique_ptr<Job>> m_pending;
+  std::vector<std::unique_ptr<Job>> m_running;
+
+  void start_pending() noexcept;
+  [[nodiscard]] runtime::Result<void, std::string> wait_events() noexcept;
+  void complete_finished() noexcept;
+  void watch(int fd, EventSource &source) noexcept;
+  void unwatch(int fd) noexcept;
+};
+
+} // namespace yabt::process
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::utils {
+
+// Returns true if both files exist and have exactly the same content.
+[[nodiscard]] runtime::Result<bool, std::string>
+files_have_same_content(const std::filesystem::path &lhs,
+                        const std::filesystem::path &rhs) noexcept;
+
+// The directory of the caches shared by all the workspaces of the user, which
+// is $XDG_CACHE_HOME/yabt or ~/.cache/yabt. Empty if neither variable is set.
+[[nodiscard]] std::optional<std::filesystem::path> user_cache_dir() noexcept;
+
+// An exclusive advisory lock on a file, held until the object is destroyed.
+// Serializes the processes sharing a cache directory.
+class FileLock final {
+public:
+  // Creates the file if needed and blocks until the lock is acquired
+  [[nodiscard]] static runtime::Result<FileLock, std::string>
+  acquire(const std::filesystem::path &path) noexcept;
+
+  FileLock(const FileLock &) noexcept = delete;
+  FileLock &operator=(const FileLock &) noexcept = delete;
+
+  FileLock(FileLock &&) noexcept;
+  FileLock &operator=(FileLock &&) noexcept = delete;
+
+  ~FileLock() noexcept;
+
+private:
+  explicit FileLock(int fd) noexcept;
+
+  int m_fd;
+};
+
+} // namespace yabt::utils
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace yabt::utils {
+
+constexpr static uint64_t FNV1A_64_OFFSET = 0xcbf29ce484222325ULL;
+constexpr static uint64_t FNV1A_64_PRIME = 0x100000001b3ULL;
+
+// Non-cryptographic hash, stable across runs and platforms. Pass the previous
+// result as `hash` to hash data incrementally.
+[[nodiscard]] constexpr uint64_t
+fnv1a_64(const std::string_view data,
+         uint64_t hash = FNV1A_64_OFFSET) noexcept {
+  for (const char c : data) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= FNV1A_64_PRIME;
+  }
+  return hash;
+}
+
+} // namespace yabt::utils
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "yabt/runtime/result.h"
+
+namespace yabt::utils {
+
+// Incremental SHA-256, for content hashes that must not collide, like cache
+// keys.
+class Sha256 final {
+public:
+  Sha256() noexcept;
+
+  void update(std::string_view data) noexcept;
+
+  // Finishes the hash and returns it as lowercase hex. The object must not be
+  // updated afterwards.
+  [[nodiscard]] std::string hex_digest() noexcept;
+
+private:
+  std::array<uint32_t, 8> m_state;
+  std::array<uint8_t, 64> m_block{};
+  size_t m_block_size{0};
+  uint64_t m_total_size{0};
+
+  void process_block() noexcept;
+};
+
+// Adds the contents of the file to the hash
+[[nodiscard]] runtime::Result<void, std::string>
+update_with_file(Sha256 &hash, const std::filesystem::path &path) noexcept;
+
+} // namespace yabt::utils
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <string_view>
 
 namespace yabt::utils {
@@ -12,4 +13,10 @@ trim_left_charset(std::string_view sv, std::string_view chars) noexcept;
 [[nodiscard]] std::string_view
 trim_right_charset(std::string_view sv, std::string_view chars) noexcept;
 
+[[nodiscard]] std::string json_escape(std::string_view unescaped) noexcept;
+
+// Escapes text for XML attributes and elements. Control characters that XML
+// cannot represent are dropped.
+[[nodiscard]] std::string xml_escape(std::string_view unescaped) noexcept;
+
 } // namespace yabt::utils
@@ -13,17 +13,27 @@ constexpr static std::string_view BUILD_DIR_NAME = "BUILD";
 constexpr static std::string_view NINJA_FILE_PATH = "build.ninja";
 constexpr static std::string_view DEPS_DIR_NAME = "DEPS";
 constexpr static std::string_view COMPDB_NAME = "compile_commands.json";
+constexpr static std::string_view COMPDB_FRAGMENTS_DIR_NAME = "compdb";
+
+constexpr static size_t DEFAULT_SYNC_JOBS = 8;
 
 enum class SyncMode {
   NORMAL,
   STRICT,
+  // Syncs the modules recorded in the lock file, without resolving anything
+  LOCKED,
 };
 
 [[nodiscard]] std::optional<std::filesystem::path>
 get_workspace_root() noexcept;
 
-[[nodiscard]] runtime::Result<void, std::string>
-sync_workspace(std::filesystem::path ws_root, SyncMode) noexcept;
+// Fetches the dependencies of the workspace, up to `jobs` of them at a time,
+// and records them in its lock file. With a cache directory, git dependencies
+// share mirrors kept in it.
+[[nodiscard]] runtime::Result<void, std::string> sync_workspace(
+    std::filesystem::path ws_root, SyncMode, size_t jobs = DEFAULT_SYNC_JOBS,
+    const std::optional<std::filesystem::path> &cache_dir =
+        std::nullopt) noexcept;
 
 runtime::Result<std::vector<std::unique_ptr<module::Module>>, std::string>
 open_workspace(const std::filesystem::path &ws_root) noexcept;
@@ -58,6 +58,9 @@ end
 ---@field ldflags ?string[]
 ---@field ldflags_post ?string[]
 ---@field toolchain ?Toolchain
+---@field timeout ?number   Seconds the test may run before it is terminated.
+---@field shardable ?boolean  Whether yabt may split the test in shards. Defaults to true.
+---@field data ?Path[]  Files or directories the test reads while it runs.
 ---@field private binary ?CcBinary
 local GtestBinary = {}
 
@@ -69,6 +72,15 @@ function GtestBinary:new(bin)
     table.insert(bin.deps, gtest_lib)
     table.insert(bin.deps, gtest_main_lib)
 
+    -- gtest binaries run a subset of their tests given GTEST_TOTAL_SHARDS
+    -- and GTEST_SHARD_INDEX
+    if bin.shardable == nil then
+        bin.shardable = true
+    end
+
+    -- Declaring the data, even when there is none, lets yabt cache the test
+    bin.data = bin.data or {}
+
     bin.ldflags_post = bin.ldflags_post or {}
     table.insert(bin.ldflags_post, '-lpthread')
 
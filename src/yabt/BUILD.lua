@@ -8,10 +8,15 @@ local embed = import 'yabt/embed'
 local rules = import 'yabt/embed/rules'
 local stubs = import 'yabt/embed/lua_stubs'
 
-targets.lib = cc.Library:new {
+targets.Lib = cc.Library:new {
     out = out('yabt.a'),
     srcs = ins(
         'build/build.cpp',
+        'build/report.cpp',
+        'build/target_matcher.cpp',
+        'build/test_cache.cpp',
+        'build/test_durations.cpp',
+        'build/test_report.cpp',
         'cli/cli_parser.cpp',
         'cli/flag.cpp',
         'cmd/build.cpp',
@@ -23,17 +28,27 @@ targets.lib = cc.Library:new {
         'cmd/clean.cpp',
         'cmd/list.cpp',
         'cmd/rules_test.cpp',
+        'cmd/write_if_changed.cpp',
+        'cmd/analyze.cpp',
         'log/log.cpp',
         'lua/lua_engine.cpp',
         'lua/path_lib.cpp',
         'lua/context_lib.cpp',
         'lua/log_lib.cpp',
+        'module/archive_module.cpp',
         'module/git_module.cpp',
+        'module/local_module.cpp',
+        'module/lock_file.cpp',
         'module/module.cpp',
         'module/module_file.cpp',
         'ninja/ninja.cpp',
+        'ninja/compdb.cpp',
+        'ninja/ninja_log.cpp',
         'process/process.cpp',
+        'process/process_pool.cpp',
         'utils/string.cpp',
+        'utils/file.cpp',
+        'utils/sha256.cpp',
         'workspace/utils.cpp',
         'embed/embed.cpp'
     ),
@@ -46,7 +61,7 @@ targets.Bin = cc.Binary:new {
         'main.cpp'
     ),
     deps = {
-        targets.lib,
+        targets.Lib,
         embed.Blob,
         rules.Utils,
         stubs.ContextBlob,
@@ -1,15 +1,28 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <map>
-#include <regex>
+#include <optional>
+#include <set>
 #include <string>
+#include <thread>
 
 #include "yabt/build/build.h"
+#include "yabt/build/report.h"
+#include "yabt/build/target_matcher.h"
+#include "yabt/build/test_cache.h"
+#include "yabt/build/test_durations.h"
+#include "yabt/build/test_report.h"
 #include "yabt/embed/embed.h"
 #include "yabt/log/log.h"
 #include "yabt/lua/lua_engine.h"
+#include "yabt/ninja/compdb.h"
 #include "yabt/ninja/ninja.h"
 #include "yabt/process/process.h"
+#include "yabt/process/process_pool.h"
 #include "yabt/workspace/utils.h"
 
 namespace yabt::build {
@@ -22,6 +35,695 @@ void register_modules(lua::LuaEngine &engine, LuaModules &modules) noexcept {
   engine.register_lua_module(modules.loglib);
 }
 
+void print_action_summaries(const std::span<const ActionSummary> summaries) {
+  for (const ActionSummary &summary : summaries) {
+    if (summary.cached) {
+      yabt_info("{} succeeded (cached)", summary.target);
+      continue;
+    }
+    const std::string shards =
+        summary.shards > 1 ? std::format(", {} shards", summary.shards) : "";
+    yabt_info("{} {} ({}{})", summary.target,
+              summary.passed ? "succeeded" : "failed",
+              summary.resource_usage.summary(), shards);
+  }
+}
+
+void print_test_summary(const std::span<const ActionSummary> summaries) {
+  const size_t passed =
+      std::count_if(summaries.begin(), summaries.end(),
+                    [](const ActionSummary &s) { return s.passed; });
+  const size_t cached =
+      std::count_if(summaries.begin(), summaries.end(),
+                    [](const ActionSummary &s) { return s.cached; });
+  if (passed == summaries.size()) {
+    yabt_info("{} of {} tests passed ({} cached)", passed, summaries.size(),
+              cached);
+  } else {
+    yabt_error("{} of {} tests failed", summaries.size() - passed,
+               summaries.size());
+  }
+}
+
+// Labels the output a test captured, so that the output of concurrent tests
+// can be told apart
+[[nodiscard]] std::string
+format_captured_output(const std::string_view target,
+                       const process::Process::ProcessOutput &output) {
+  std::string text;
+  for (const auto &[name, stream] :
+       {std::pair{"stdout", &output.stdout}, {"stderr", &output.stderr}}) {
+    if (stream->has_value() && !stream->value().empty()) {
+      text += std::format("---- {} of {} ----\n", name, target);
+      text += stream->value();
+      if (stream->value().back() != '\n') {
+        text.push_back('\n');
+      }
+    }
+  }
+  return text;
+}
+
+void print_captured_output(const std::string_view text) {
+  std::fwrite(text.data(), 1, text.size(), stdout);
+  std::fflush(stdout);
+}
+
+[[nodiscard]] std::unique_ptr<process::Process>
+make_action_process(const BuildOptions &options,
+                    const lua::ContextLib &contextlib,
+                    const std::string &target,
+                    const std::span<const std::string> exec_argv) {
+  std::string arg_string = "";
+  for (const std::string_view arg : exec_argv) {
+    arg_string.append(arg);
+    arg_string.push_back(' ');
+  }
+  yabt_verbose("Running {}", arg_string);
+
+  auto process =
+      std::make_unique<process::Process>(exec_argv[0], exec_argv.subspan(1));
+  if (const auto timeout = contextlib.target_timeouts.find(target);
+      timeout != contextlib.target_timeouts.cend()) {
+    process->set_timeout(timeout->second);
+  } else if (options.timeout.has_value()) {
+    process->set_timeout(options.timeout.value());
+  }
+  return process;
+}
+
+// Runs the targets one after the other, attached to the terminal
+[[nodiscard]] runtime::Result<void, std::string>
+run_targets(const BuildOptions &options, lua::ContextLib &contextlib,
+            const std::span<const std::string> targets,
+            const std::span<const std::string_view> action_args) {
+  std::vector<ActionSummary> summaries;
+  runtime::Result<void, std::string> action_result =
+      runtime::Result<void, std::string>::ok();
+
+  for (const std::string &target : targets) {
+    yabt_verbose("Collecting run arguments for {}", target);
+    const std::vector<std::string> exec_argv =
+        RESULT_PROPAGATE(contextlib.call_run_fn(target, action_args));
+
+    const std::unique_ptr<process::Process> run_process =
+        make_action_process(options, contextlib, target, exec_argv);
+    RESULT_PROPAGATE_DISCARD(run_process->start());
+    const process::Process::ProcessOutput output =
+        run_process->process_output();
+
+    action_result = output.to_result();
+    summaries.push_back(ActionSummary{
+        .target{target},
+        .passed = action_result.is_ok(),
+        .resource_usage = output.resource_usage,
+        .exit_reason = describe_exit(output),
+    });
+    if (process::interrupted()) {
+      action_result = runtime::Result<void, std::string>::error("Interrupted");
+    }
+    if (action_result.is_error()) {
+      break;
+    }
+  }
+
+  print_action_summaries(summaries);
+  return action_result;
+}
+
+[[nodiscard]] std::unique_ptr<process::Process>
+make_ninja_process(const std::filesystem::path &build_dir, const int threads,
+                   const std::span<const std::string> targets) {
+  auto ninja = std::make_unique<process::Process>(
+      "ninja", "-j", std::format("{}", threads), targets);
+  ninja->set_cwd(build_dir.native());
+  return ninja;
+}
+
+// Manifest building the targets under test, on top of the main one
+constexpr static std::string_view TEST_NINJA_FILE_NAME = "tests.ninja";
+constexpr static std::string_view TEST_NINJA_TARGET = "yabt_tests";
+constexpr static std::string_view TEST_READY_DESCRIPTION = "TEST_READY ";
+
+// Prefixes ninja's status lines with the number of running steps, between two
+// unit separators that do not show up in build output
+constexpr static std::string_view NINJA_STATUS_MARKER = "\x1f";
+constexpr static std::string_view NINJA_STATUS = "\x1f%r\x1f[%f/%t] ";
+
+// Adds a step per test to the main manifest, which runs on every build once
+// the target of the test is built. Ninja prints nothing when a phony target is
+// built, but prints the description of these steps when they finish.
+[[nodiscard]] runtime::Result<void, std::string>
+write_test_manifest(const std::filesystem::path &build_dir,
+                    const std::span<const std::string> targets,
+                    const std::span<const std::string> tested_targets) {
+  const std::filesystem::path path = build_dir / TEST_NINJA_FILE_NAME;
+  std::ofstream stream{path};
+  stream << "include " << workspace::NINJA_FILE_PATH << "\n\n";
+  stream << "rule yabt_test_ready\n"
+         << "    command = true\n"
+         << "    description = " << TEST_READY_DESCRIPTION << "$target\n\n";
+  // A phony step without inputs is always out of date, and so is anything
+  // depending on it
+  stream << "build yabt_always: phony\n";
+  std::vector<std::string> outputs{targets.begin(), targets.end()};
+  for (size_t i = 0; i < tested_targets.size(); i++) {
+    outputs.push_back(std::format(".yabt_test_ready/{}", i));
+    stream << "build " << outputs.back() << ": yabt_test_ready "
+           << tested_targets[i] << " yabt_always\n"
+           << "    target = " << tested_targets[i] << '\n';
+  }
+  stream << "build " << TEST_NINJA_TARGET << ": phony";
+  for (const std::string &output : outputs) {
+    stream << ' ' << output;
+  }
+  stream << '\n';
+
+  if (!stream) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to write {}", path.native()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+// Tests of shardable targets are split in shards of about this duration,
+// shorter shards are not worth starting the test binary once more
+constexpr static std::chrono::milliseconds SHARD_DURATION{1000};
+
+// Time the tests take when `workers` processes run them concurrently, taking
+// the longest one first whenever a worker becomes free
+[[nodiscard]] std::chrono::milliseconds
+lpt_makespan(std::vector<std::chrono::milliseconds> durations,
+             const size_t workers) {
+  std::sort(durations.begin(), durations.end(), std::greater{});
+  std::vector<std::chrono::milliseconds> loads(workers);
+  for (const std::chrono::milliseconds duration : durations) {
+    *std::min_element(loads.begin(), loads.end()) += duration;
+  }
+  return *std::max_element(loads.begin(), loads.end());
+}
+
+// Runs the tests concurrently, capturing their output. The output of a test
+// is only printed when it fails, or in verbose mode. Shardable tests that took
+// long in the previous run are split in shards that run concurrently, and
+// reported as a single result.
+//
+// Tests start longest first according to their previous durations, so that a
+// long test does not start last and delay the end of the run.
+//
+// With `build_targets`, the targets are built along the way by a single ninja
+// run, and each test starts as soon as ninja reports its target built. Ninja
+// and the tests share the jobs: tests only take the ones ninja leaves idle.
+class TestRunner final {
+public:
+  TestRunner(const BuildOptions &options, const lua::ContextLib &contextlib,
+             const std::filesystem::path &build_dir, const bool build_targets,
+             std::map<std::string, std::vector<std::string>> test_argvs)
+      : m_options{options}, m_contextlib{contextlib}, m_build_dir{build_dir},
+        m_build_targets{build_targets}, m_test_argvs{std::move(test_argvs)},
+        m_jobs{options.test_jobs > 0
+                   ? options.test_jobs
+                   : std::max(std::thread::hardware_concurrency(), 1u)},
+        m_pool{m_jobs} {
+    if (options.test_cache) {
+      m_cache.emplace(build_dir / TEST_CACHE_DIR_NAME);
+      for (const ninja::BuildStep &step : contextlib.build_steps) {
+        for (const lua::OutPath &out : step.outs) {
+          m_step_ins.emplace(out.path, StepIns{&step.ins, false});
+        }
+      }
+      for (const ninja::BuildStepWithRule &step :
+           contextlib.build_steps_with_rule) {
+        for (const lua::OutPath &out : step.outs) {
+          m_step_ins.emplace(out.path,
+                             StepIns{&step.ins, step.rule_name == "phony"});
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  run(const std::span<const std::string> targets) {
+    const std::filesystem::path durations_path =
+        m_build_dir / TEST_DURATIONS_FILE_NAME;
+    if (runtime::Result durations = load_test_durations(durations_path);
+        durations.is_ok()) {
+      m_durations = std::move(durations).ok_value();
+    } else {
+      yabt_debug("Ignoring test durations: {}", durations.error_value());
+    }
+    if (!m_durations.empty()) {
+      std::chrono::milliseconds total{};
+      for (const auto &[_, duration] : m_durations) {
+        total += duration;
+      }
+      m_average_duration = total / m_durations.size();
+    }
+
+    if (m_build_targets) {
+      RESULT_PROPAGATE_DISCARD(submit_build(targets));
+    } else {
+      for (const auto &[target, _] : m_test_argvs) {
+        submit_test(target);
+      }
+    }
+    RESULT_PROPAGATE_DISCARD(m_pool.run());
+    add_missing_summaries();
+
+    if (const runtime::Result saved =
+            save_test_durations(durations_path, m_durations);
+        saved.is_error()) {
+      yabt_warn("Unable to save test durations: {}", saved.error_value());
+    }
+
+    std::sort(m_summaries.begin(), m_summaries.end(),
+              [](const ActionSummary &a, const ActionSummary &b) {
+                return a.target < b.target;
+              });
+    print_action_summaries(m_summaries);
+    print_test_summary(m_summaries);
+    print_makespan();
+
+    if (m_options.junit_report.has_value()) {
+      RESULT_PROPAGATE_DISCARD(
+          write_junit_report(m_options.junit_report.value(), m_summaries));
+    }
+    if (m_options.json_report.has_value()) {
+      RESULT_PROPAGATE_DISCARD(
+          write_json_report(m_options.json_report.value(), m_summaries));
+    }
+
+    if (process::interrupted()) {
+      return runtime::Result<void, std::string>::error("Interrupted");
+    }
+    RESULT_PROPAGATE_DISCARD(m_build_result);
+    if (std::any_of(m_summaries.begin(), m_summaries.end(),
+                    [](const ActionSummary &s) { return !s.passed; })) {
+      return runtime::Result<void, std::string>::error("Some tests failed");
+    }
+    return runtime::Result<void, std::string>::ok();
+  }
+
+private:
+  // A target under test, whose shards may still be running
+  struct TestRun final {
+    ActionSummary summary;
+    size_t pending_shards;
+    std::chrono::milliseconds total_duration{};
+    std::optional<std::string> cache_key{};
+  };
+
+  // Inputs of the build step producing an output
+  struct StepIns final {
+    const std::vector<lua::Path> *ins;
+    bool phony;
+  };
+
+  using ProcessResult =
+      runtime::Result<process::Process::ProcessOutput, std::string>;
+
+  const BuildOptions &m_options;
+  const lua::ContextLib &m_contextlib;
+  std::filesystem::path m_build_dir;
+  bool m_build_targets;
+  std::map<std::string, std::vector<std::string>> m_test_argvs;
+  size_t m_jobs;
+  process::ProcessPool m_pool;
+  std::optional<TestCache> m_cache{};
+  std::map<std::string, StepIns> m_step_ins{};
+  TestDurations m_durations{};
+  std::vector<std::unique_ptr<TestRun>> m_runs{};
+  std::vector<ActionSummary> m_summaries{};
+
+  // Used for tests without a recorded duration
+  std::optional<std::chrono::milliseconds> m_average_duration{};
+  std::vector<std::chrono::milliseconds> m_predicted_shard_durations{};
+  bool m_predictions_complete{true};
+  std::optional<std::chrono::steady_clock::time_point> m_first_test_start{};
+  std::chrono::steady_clock::time_point m_last_test_end{};
+
+  std::set<std::string> m_submitted{};
+  runtime::Result<void, std::string> m_build_result =
+      runtime::Result<void, std::string>::ok();
+
+  // Tests that never started, because their build failed or yabt was
+  // interrupted, fail too, so that reports have an entry for every target
+  void add_missing_summaries() {
+    std::set<std::string> summarized;
+    for (const ActionSummary &summary : m_summaries) {
+      summarized.insert(summary.target);
+    }
+
+    const std::string exit_reason =
+        m_build_result.is_error() ? "not built"
+        : process::interrupted()  ? "not run: interrupted"
+                                  : "not run";
+    for (const auto &[target, _] : m_test_argvs) {
+      if (summarized.contains(target)) {
+        continue;
+      }
+      m_summaries.push_back(ActionSummary{
+          .target{target},
+          .passed = false,
+          .resource_usage{},
+          .exit_reason{exit_reason},
+      });
+    }
+  }
+
+  [[nodiscard]] runtime::Result<void, std::string>
+  submit_build(const std::span<const std::string> targets) {
+    std::vector<std::string> tested_targets;
+    for (const auto &[target, _] : m_test_argvs) {
+      tested_targets.push_back(target);
+    }
+    RESULT_PROPAGATE_DISCARD(
+        write_test_manifest(m_build_dir, targets, tested_targets));
+
+    const int ninja_jobs =
+        m_options.threads > 0 ? m_options.threads : static_cast<int>(m_jobs);
+    auto ninja = std::make_unique<process::Process>(
+        "ninja", "-f", TEST_NINJA_FILE_NAME, "-j",
+        std::format("{}", ninja_jobs), TEST_NINJA_TARGET);
+    ninja->set_cwd(m_build_dir.native());
+    ninja->set_env("NINJA_STATUS", NINJA_STATUS);
+    ninja->set_line_callback([this](const process::Process::Stream stream,
+                                    const std::string_view line) {
+      handle_ninja_line(stream, line);
+    });
+
+    // Until ninja reports how many steps it runs, it has every job
+    m_pool.set_max_concurrency(1);
+    m_pool.submit_first(
+        std::move(ninja), true, [this](ProcessResult output) {
+          m_build_result = output.is_ok()
+                               ? output.ok_value().to_result()
+                               : runtime::Result<void, std::string>::error(
+                                     std::move(output).error_value());
+          m_pool.set_max_concurrency(m_jobs);
+          if (m_build_result.is_error()) {
+            return;
+          }
+
+          // Should ninja not have reported some tests, they are built now
+          for (const auto &[target, _] : m_test_argvs) {
+            if (!m_submitted.contains(target)) {
+              submit_test(target);
+            }
+          }
+        });
+    return runtime::Result<void, std::string>::ok();
+  }
+
+  // Forwards the output of ninja, except for the status lines of the steps
+  // reporting built tests, which start the tests instead
+  void handle_ninja_line(const process::Process::Stream stream,
+                         std::string_view line) {
+    FILE *const output =
+        stream == process::Process::Stream::STDERR ? stderr : stdout;
+    if (line.starts_with(NINJA_STATUS_MARKER)) {
+      line.remove_prefix(NINJA_STATUS_MARKER.size());
+      const size_t end = line.find(NINJA_STATUS_MARKER);
+      size_t running = 0;
+      if (end != std::string_view::npos &&
+          std::from_chars(line.data(), line.data() + end, running).ec ==
+              std::errc{}) {
+        // The ninja process itself takes a slot too
+        m_pool.set_max_concurrency(1 + m_jobs - std::min(running, m_jobs));
+        line.remove_prefix(end + NINJA_STATUS_MARKER.size());
+      }
+
+      const size_t description = line.find("] ");
+      if (description != std::string_view::npos &&
+          line.substr(description + 2).starts_with(TEST_READY_DESCRIPTION)) {
+        const std::string target{
+            line.substr(description + 2 + TEST_READY_DESCRIPTION.size())};
+        if (m_test_argvs.contains(target) && !m_submitted.contains(target)) {
+          submit_test(target);
+        }
+        return;
+      }
+    }
+    std::fwrite(line.data(), 1, line.size(), output);
+    std::fputc('\n', output);
+    std::fflush(output);
+  }
+
+  [[nodiscard]] std::optional<std::chrono::milliseconds>
+  predicted_duration(const std::string &target) const {
+    if (const auto duration = m_durations.find(target);
+        duration != m_durations.cend()) {
+      return duration->second;
+    }
+    return m_average_duration;
+  }
+
+  void print_makespan() const {
+    if (!m_first_test_start.has_value() ||
+        m_predicted_shard_durations.empty()) {
+      return;
+    }
+    const double actual =
+        std::chrono::duration<double>{m_last_test_end -
+                                      m_first_test_start.value()}
+            .count();
+    const double predicted =
+        std::chrono::duration<double>{
+            lpt_makespan(m_predicted_shard_durations, m_jobs)}
+            .count();
+    yabt_info("Tests ran for {:.1f}s, {:.1f}s predicted{}", actual, predicted,
+              m_predictions_complete ? "" : " (some tests had no history)");
+  }
+
+  [[nodiscard]] size_t shard_count(const std::string &target) const {
+    const auto duration = m_durations.find(target);
+    if (!m_contextlib.shardable_targets.contains(target) ||
+        duration == m_durations.cend()) {
+      return 1;
+    }
+    const auto shards =
+        (duration->second + SHARD_DURATION - std::chrono::milliseconds{1}) /
+        SHARD_DURATION;
+    return std::clamp<size_t>(shards, 1, m_jobs);
+  }
+
+  // The outputs of the target and its declared data, plus everything built
+  // for them. None for targets without declared data, whose tests may read
+  // anything.
+  [[nodiscard]] std::optional<TestInputs>
+  test_inputs(const std::string &target,
+              const std::span<const std::string> argv) const {
+    const auto data = m_contextlib.target_runtime_inputs.find(target);
+    const auto target_step = m_step_ins.find(target);
+    if (data == m_contextlib.target_runtime_inputs.cend() ||
+        target_step == m_step_ins.cend()) {
+      return std::nullopt;
+    }
+
+    TestInputs inputs{
+        .argv = argv,
+        .files{data->second.begin(), data->second.end()},
+        .built_files{},
+    };
+    const std::vector<lua::Path> &outputs = *target_step->second.ins;
+    for (const lua::Path &output : outputs) {
+      inputs.files.emplace_back(output.path);
+    }
+
+    std::set<std::string> seen{target};
+    std::vector<std::string> pending{target};
+    while (!pending.empty()) {
+      const auto step = m_step_ins.find(pending.back());
+      pending.pop_back();
+      for (const lua::Path &in : *step->second.ins) {
+        if (!seen.insert(in.path).second) {
+          continue;
+        }
+        // Sources are not built, they only matter through what is built
+        // from them
+        const auto in_step = m_step_ins.find(in.path);
+        if (in_step == m_step_ins.cend()) {
+          continue;
+        }
+        pending.push_back(in.path);
+        if (!in_step->second.phony &&
+            std::none_of(outputs.cbegin(), outputs.cend(),
+                         [&in](const lua::Path &output) {
+                           return output.path == in.path;
+                         })) {
+          inputs.built_files.emplace_back(in.path);
+        }
+      }
+    }
+    return inputs;
+  }
+
+  // The cache key hashes the outputs of the target, so it is only computed
+  // once the target is built
+  void submit_test(const std::string &target) {
+    m_submitted.insert(target);
+    const std::vector<std::string> &exec_argv = m_test_argvs[target];
+    std::optional<std::string> cache_key;
+    const std::optional<TestInputs> inputs =
+        m_cache.has_value() ? test_inputs(target, exec_argv) : std::nullopt;
+    if (m_cache.has_value() && !inputs.has_value()) {
+      yabt_debug("Not caching {}: it does not declare its data", target);
+    } else if (m_cache.has_value()) {
+      runtime::Result key = m_cache->key(inputs.value());
+      if (key.is_error()) {
+        yabt_debug("Not caching {}: {}", target, key.error_value());
+      } else if (m_cache->has_passed(key.ok_value())) {
+        yabt_verbose("{} passed before, skipping it", target);
+        m_summaries.push_back(ActionSummary{
+            .target{target},
+            .passed = true,
+            .resource_usage{},
+            .cached = true,
+            .exit_reason{"cached"},
+        });
+        return;
+      } else {
+        cache_key = std::move(key).ok_value();
+      }
+    }
+
+    const size_t shards = shard_count(target);
+    const std::optional<std::chrono::milliseconds> predicted =
+        predicted_duration(target);
+    const int64_t priority = predicted.has_value()
+                                 ? (predicted.value() / shards).count()
+                                 : 0;
+    if (predicted.has_value()) {
+      m_predicted_shard_durations.insert(m_predicted_shard_durations.end(),
+                                         shards, predicted.value() / shards);
+    }
+    m_predictions_complete =
+        m_predictions_complete && m_durations.contains(target);
+    if (!m_first_test_start.has_value()) {
+      m_first_test_start = std::chrono::steady_clock::now();
+    }
+
+    m_runs.push_back(std::make_unique<TestRun>(TestRun{
+        .summary{
+            .target{target},
+            .passed = true,
+            .resource_usage{},
+            .shards = shards,
+        },
+        .pending_shards = shards,
+        .cache_key = std::move(cache_key),
+    }));
+    TestRun &run = *m_runs.back();
+
+    for (size_t shard = 0; shard < shards; shard++) {
+      std::unique_ptr<process::Process> process =
+          make_action_process(m_options, m_contextlib, target, exec_argv);
+      if (shards > 1) {
+        process->set_env("GTEST_TOTAL_SHARDS", std::format("{}", shards));
+        process->set_env("GTEST_SHARD_INDEX", std::format("{}", shard));
+      }
+      m_pool.submit(
+          std::move(process), true,
+          [this, &run, shard](ProcessResult output) {
+            complete_shard(run, shard, std::move(output));
+          },
+          priority);
+    }
+  }
+
+  void complete_shard(TestRun &run, const size_t shard, ProcessResult output) {
+    m_last_test_end = std::chrono::steady_clock::now();
+    ActionSummary &summary = run.summary;
+    const std::string name =
+        summary.shards > 1
+            ? std::format("{} (shard {}/{})", summary.target, shard + 1,
+                          summary.shards)
+            : summary.target;
+
+    // The first failing shard decides the exit reason of the target
+    if (output.is_error()) {
+      yabt_error("{} did not run: {}", name, output.error_value());
+      if (summary.passed) {
+        summary.exit_reason = std::format("not run: {}", output.error_value());
+      }
+      summary.passed = false;
+    } else {
+      const process::Process::ProcessOutput &process_output =
+          output.ok_value();
+      const runtime::Result<void, std::string> result =
+          process_output.to_result();
+      if (result.is_error()) {
+        const std::string_view error = result.error_value();
+        yabt_error("{} failed: {}", name, error.substr(0, error.find('\n')));
+        const std::string captured =
+            format_captured_output(name, process_output);
+        print_captured_output(captured);
+        summary.failure_output += captured;
+        if (summary.passed) {
+          summary.exit_reason = describe_exit(process_output);
+        }
+        summary.passed = false;
+      } else if (log::is_level_enabled(log::LogLevel::VERBOSE)) {
+        print_captured_output(format_captured_output(name, process_output));
+      }
+
+      // Shards run concurrently: the wall time of the target is the one of
+      // its slowest shard, while CPU time adds up
+      const process::Process::ResourceUsage &usage =
+          process_output.resource_usage;
+      summary.resource_usage.wall_time =
+          std::max(summary.resource_usage.wall_time, usage.wall_time);
+      summary.resource_usage.user_time += usage.user_time;
+      summary.resource_usage.system_time += usage.system_time;
+      summary.resource_usage.max_rss_kib =
+          std::max(summary.resource_usage.max_rss_kib, usage.max_rss_kib);
+      run.total_duration +=
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              usage.wall_time);
+    }
+
+    if (--run.pending_shards > 0) {
+      return;
+    }
+
+    if (summary.passed) {
+      summary.exit_reason = "exit code 0";
+    }
+    m_durations[summary.target] = run.total_duration;
+    if (summary.passed && run.cache_key.has_value()) {
+      if (const runtime::Result recorded =
+              m_cache->record_pass(run.cache_key.value(), summary.target);
+          recorded.is_error()) {
+        yabt_warn("Unable to cache the result of {}: {}", summary.target,
+                  recorded.error_value());
+      }
+    }
+    m_summaries.push_back(summary);
+  }
+};
+
+[[nodiscard]] runtime::Result<void, std::string>
+test_targets(const BuildOptions &options, lua::ContextLib &contextlib,
+             const std::filesystem::path &build_dir, const bool build_targets,
+             const std::span<const std::string> targets,
+             const std::span<const std::string_view> action_args) {
+  std::map<std::string, std::vector<std::string>> test_argvs;
+  for (const std::string &target : targets) {
+    // FIXME: This should be handled inside call_run_fn and call_test_fn
+    if (!contextlib.test_fn_refs.contains(target)) {
+      yabt_debug("Skipping {} (no test function registered)", target);
+      continue;
+    }
+    yabt_verbose("Collecting test arguments for {}", target);
+    test_argvs[target] =
+        RESULT_PROPAGATE(contextlib.call_test_fn(target, action_args));
+  }
+
+  TestRunner runner{options, contextlib, build_dir, build_targets,
+                    std::move(test_argvs)};
+  return runner.run(targets);
+}
+
 } // namespace
 
 [[nodiscard]] std::unique_ptr<LuaModules> construct_lua_modules(
@@ -135,8 +837,7 @@ runtime::Result<lua::LuaEngine, std::string> prepare_lua_engine(
 }
 
 [[nodiscard]] runtime::Result<void, std::string>
-execute_build(const int threads, const bool compdb,
-              const std::optional<std::filesystem::path> &requested_build_dir,
+execute_build(const BuildOptions &options,
               const std::span<const std::string_view> target_patterns,
               const PostBuildMode mode,
               const std::span<const std::string_view> action_args) {
@@ -150,7 +851,7 @@ execute_build(const int threads, const bool compdb,
   }
 
   const std::filesystem::path build_dir =
-      std::filesystem::absolute(requested_build_dir.value_or(
+      std::filesystem::absolute(options.build_dir.value_or(
           ws_root.value() / workspace::BUILD_DIR_NAME));
 
   auto modules = RESULT_PROPAGATE(workspace::open_workspace(ws_root.value()));
@@ -163,96 +864,84 @@ execute_build(const int threads, const bool compdb,
   const std::filesystem::path ninja_file =
       build_dir / workspace::NINJA_FILE_PATH;
 
-  RESULT_PROPAGATE_DISCARD(
-      ninja::save_ninja_file(ninja_file, lua_modules->contextlib.build_rules,
-                             lua_modules->contextlib.build_steps,
-                             lua_modules->contextlib.build_steps_with_rule));
+  // Durations of previous builds let ninja start the longest chains first
+  ninja::StepDurations step_durations;
+  if (auto durations = ninja::load_step_durations(
+          build_dir / ninja::NINJA_LOG_FILE_NAME);
+      durations.is_ok()) {
+    step_durations = std::move(durations).ok_value();
+  } else {
+    yabt_debug("Not scheduling by step durations: {}",
+               durations.error_value());
+  }
 
-  if (compdb) {
-    std::vector<std::string> compdb_rules;
-    for (const auto &[name, rule] : lua_modules->contextlib.build_rules) {
-      if (rule.compdb) {
-        compdb_rules.push_back(name);
-      }
+  RESULT_PROPAGATE_DISCARD(ninja::save_ninja_file(
+      ninja_file, lua_modules->contextlib.build_rules,
+      lua_modules->contextlib.build_steps,
+      lua_modules->contextlib.build_steps_with_rule, step_durations));
+
+  if (options.compdb != CompdbMode::None) {
+    std::optional<ninja::CompdbFragments> fragments;
+    if (options.compdb == CompdbMode::WithFragments) {
+      fragments = ninja::CompdbFragments{
+          .source_root{ws_root.value()},
+          .output_dir{build_dir / workspace::COMPDB_FRAGMENTS_DIR_NAME},
+      };
     }
-    process::Process ninja{"ninja", "-t", "compdb",
-                           std::span<const std::string>{compdb_rules}};
-    ninja.set_cwd((build_dir).native());
-    RESULT_PROPAGATE_DISCARD(ninja.start(true));
-    const process::Process::ProcessOutput output = ninja.process_output();
-    RESULT_PROPAGATE_DISCARD(output.to_result());
-
-    const std::filesystem::path compdb_path =
-        build_dir / workspace::COMPDB_NAME;
-
-    std::ofstream compdb_stream;
-    compdb_stream.open(compdb_path.native());
-    compdb_stream << output.stdout.value();
-    compdb_stream.close();
+    RESULT_PROPAGATE_DISCARD(ninja::save_compdb_file(
+        build_dir / workspace::COMPDB_NAME, build_dir,
+        lua_modules->contextlib.build_rules,
+        lua_modules->contextlib.build_steps_with_rule, fragments));
   }
 
   // Find all matching targets for a pattern
-  std::vector<std::regex> patterns;
-  for (const std::string_view target_pattern : target_patterns) {
-    patterns.emplace_back(std::string{target_pattern});
-  }
-
-  std::vector<std::string> targets{};
-  for (const std::string &target : lua_modules->contextlib.all_targets) {
-    for (const std::regex &regex : patterns) {
-      if (std::regex_match(target, regex)) {
-        targets.push_back(target);
-        break; // don't add a target more than once
-      }
-    }
-  }
+  const TargetMatcher matcher =
+      RESULT_PROPAGATE(TargetMatcher::compile(target_patterns));
+  const std::vector<std::string> targets =
+      matcher.match(lua_modules->contextlib.all_targets);
 
   if (targets.size() == 0) {
     yabt_warn("No matched targets");
     return runtime::Result<void, std::string>::ok();
   }
 
+  process::forward_interrupts();
+
+  // Tests build their targets themselves, so that they can start before the
+  // whole build finishes. A build report needs a single ninja run though.
+  const bool pipeline_tests = mode == PostBuildMode::Test && !options.report;
+  if (pipeline_tests) {
+    return test_targets(options, lua_modules->contextlib, build_dir, true,
+                        targets, action_args);
+  }
+
   // Run build process
   yabt_verbose("Executing build process");
-  const std::string threads_str = std::format("{}", threads);
-  process::Process ninja{"ninja", "-j", threads_str,
-                         std::span<const std::string>{targets}};
-  ninja.set_cwd((build_dir).native());
-  RESULT_PROPAGATE_DISCARD(ninja.start());
-  RESULT_PROPAGATE_DISCARD(ninja.process_output().to_result());
+  const std::unique_ptr<process::Process> ninja =
+      make_ninja_process(build_dir, options.threads, targets);
+  RESULT_PROPAGATE_DISCARD(ninja->start());
+  const runtime::Result<void, std::string> build_result =
+      ninja->process_output().to_result();
+  if (process::interrupted()) {
+    return runtime::Result<void, std::string>::error("Interrupted");
+  }
+
+  // Also report failed builds, the log contains the steps that finished
+  if (options.report) {
+    RESULT_PROPAGATE_DISCARD(
+        report_build(build_dir, lua_modules->contextlib, DEFAULT_REPORT_STEPS));
+  }
+  RESULT_PROPAGATE_DISCARD(build_result);
 
   // If run or test were given, take the time to run/test the corresponding
   // targets.
-  if (mode != PostBuildMode::None) {
-    for (const std::string &target : targets) {
-      std::vector<std::string> exec_argv;
-      if (mode == PostBuildMode::Run) {
-        yabt_verbose("Collecting run arguments for {}", target);
-        exec_argv = RESULT_PROPAGATE(
-            lua_modules->contextlib.call_run_fn(target, action_args));
-      } else if (mode == PostBuildMode::Test) {
-        // FIXME: This should be handled inside call_run_fn and call_test_fn
-        if (!lua_modules->contextlib.test_fn_refs.contains(target)) {
-          yabt_debug("Skipping {} (no test function registered)", target);
-          continue;
-        }
-        yabt_verbose("Collecting test arguments for {}", target);
-        exec_argv = RESULT_PROPAGATE(
-            lua_modules->contextlib.call_test_fn(target, action_args));
-      }
-
-      std::string arg_string = "";
-      for (const std::string_view arg : exec_argv) {
-        arg_string.append(arg);
-        arg_string.push_back(' ');
-      }
-      yabt_verbose("Running {}", arg_string);
-
-      process::Process run_process{
-          exec_argv[0], std::span<const std::string>{exec_argv}.subspan(1)};
-      RESULT_PROPAGATE_DISCARD(run_process.start());
-      RESULT_PROPAGATE_DISCARD(run_process.process_output().to_result());
-    }
+  if (mode == PostBuildMode::Run) {
+    RESULT_PROPAGATE_DISCARD(run_targets(options, lua_modules->contextlib,
+                                         targets, action_args));
+  } else if (mode == PostBuildMode::Test) {
+    RESULT_PROPAGATE_DISCARD(test_targets(options, lua_modules->contextlib,
+                                          build_dir, false, targets,
+                                          action_args));
   }
 
   return runtime::Result<void, std::string>::ok();
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/build/report.h"
+#include "yabt/ninja/ninja_log.h"
+
+namespace yabt::build {
+
+namespace {
+
+constexpr static std::string_view NO_TARGET = "(no target)";
+
+// A step of the last run, joined with the build graph
+struct ExecutedStep final {
+  std::string_view output;
+  std::string_view target;
+  uint64_t start_ms;
+  uint64_t end_ms;
+  // Indices of the executed steps producing the inputs of this one
+  std::vector<size_t> deps;
+  // Longest chain of executed steps ending with this one
+  uint64_t path_ms;
+  std::optional<size_t> path_prev;
+
+  [[nodiscard]] uint64_t duration_ms() const noexcept {
+    return end_ms - start_ms;
+  }
+};
+
+[[nodiscard]] std::string format_duration(const uint64_t ms) noexcept {
+  return std::format("{:>8.2f}s", static_cast<double>(ms) / 1000.0);
+}
+
+// Maps each output to the inputs of the step producing it
+[[nodiscard]] std::map<std::string_view, const std::vector<lua::Path> *>
+collect_step_inputs(const lua::ContextLib &contextlib) noexcept {
+  std::map<std::string_view, const std::vector<lua::Path> *> inputs;
+  for (const ninja::BuildStep &step : contextlib.build_steps) {
+    for (const lua::OutPath &out : step.outs) {
+      inputs.insert(std::pair{std::string_view{out.path}, &step.ins});
+    }
+  }
+  for (const ninja::BuildStepWithRule &step :
+       contextlib.build_steps_with_rule) {
+    if (step.rule_name == "phony") {
+      continue;
+    }
+    for (const lua::OutPath &out : step.outs) {
+      inputs.insert(std::pair{std::string_view{out.path}, &step.ins});
+    }
+  }
+  return inputs;
+}
+
+[[nodiscard]] std::vector<ExecutedStep>
+join_with_graph(const std::vector<ninja::NinjaLogEntry> &entries,
+                const lua::ContextLib &contextlib) noexcept {
+  std::vector<ExecutedStep> steps;
+  std::map<std::string_view, size_t> step_by_output;
+  // Steps with several outputs have one entry per output with the same times
+  std::map<std::pair<uint64_t, uint64_t>, std::vector<size_t>> steps_by_time;
+
+  const auto step_inputs = collect_step_inputs(contextlib);
+
+  for (const ninja::NinjaLogEntry &entry : entries) {
+    const auto inputs = step_inputs.find(entry.output);
+    auto &same_time = steps_by_time[{entry.start_ms, entry.end_ms}];
+    const auto sibling =
+        std::find_if(same_time.cbegin(), same_time.cend(), [&](size_t i) {
+          const auto other = step_inputs.find(steps[i].output);
+          return inputs != step_inputs.cend() && other != step_inputs.cend() &&
+                 inputs->second == other->second;
+        });
+    if (sibling != same_time.cend()) {
+      step_by_output[entry.output] = *sibling;
+      continue;
+    }
+
+    const auto target = contextlib.output_targets.find(entry.output);
+    steps.push_back(ExecutedStep{
+        .output{entry.output},
+        .target{target != contextlib.output_targets.cend()
+                    ? std::string_view{target->second}
+                    : NO_TARGET},
+        .start_ms = entry.start_ms,
+        .end_ms = entry.end_ms,
+        .deps{},
+        .path_ms = 0,
+        .path_prev{},
+    });
+    step_by_output[entry.output] = steps.size() - 1;
+    same_time.push_back(steps.size() - 1);
+  }
+
+  for (ExecutedStep &step : steps) {
+    const auto inputs = step_inputs.find(step.output);
+    if (inputs == step_inputs.cend()) {
+      continue;
+    }
+    for (const lua::Path &in : *inputs->second) {
+      if (const auto dep = step_by_output.find(in.path);
+          dep != step_by_output.cend()) {
+        step.deps.push_back(dep->second);
+      }
+    }
+  }
+
+  return steps;
+}
+
+// Computes the longest chain of dependent steps. Returns the index of its
+// last step.
+[[nodiscard]] size_t compute_critical_path(std::vector<ExecutedStep> &steps) {
+  // A dependency always finishes before its dependents start, so visiting
+  // the steps by start time handles dependencies first.
+  std::vector<size_t> order(steps.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return std::pair{steps[lhs].start_ms, steps[lhs].end_ms} <
+           std::pair{steps[rhs].start_ms, steps[rhs].end_ms};
+  });
+
+  size_t last = order.front();
+  for (const size_t i : order) {
+    ExecutedStep &step = steps[i];
+    for (const size_t dep : step.deps) {
+      if (steps[dep].path_ms > step.path_ms) {
+        step.path_ms = steps[dep].path_ms;
+        step.path_prev = dep;
+      }
+    }
+    step.path_ms += step.duration_ms();
+    if (step.path_ms > steps[last].path_ms) {
+      last = i;
+    }
+  }
+  return last;
+}
+
+void print_critical_path(const std::vector<ExecutedStep> &steps,
+                         const size_t last) {
+  std::vector<size_t> path;
+  for (std::optional<size_t> i = last; i.has_value(); i = steps[*i].path_prev) {
+    path.push_back(*i);
+  }
+  std::reverse(path.begin(), path.end());
+
+  puts(std::format("Critical path ({} steps, {}):", path.size(),
+                   format_duration(steps[last].path_ms))
+           .c_str());
+  for (const size_t i : path) {
+    puts(std::format("  {}  {}  {}", format_duration(steps[i].duration_ms()),
+                     steps[i].target, steps[i].output)
+             .c_str());
+  }
+}
+
+void print_slowest_steps(const std::vector<ExecutedStep> &steps,
+                         const size_t top_steps) {
+  std::vector<const ExecutedStep *> sorted;
+  for (const ExecutedStep &step : steps) {
+    sorted.push_back(&step);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const ExecutedStep *lhs, const ExecutedStep *rhs) {
+              return lhs->duration_ms() > rhs->duration_ms();
+            });
+  sorted.resize(std::min(sorted.size(), top_steps));
+
+  puts("Slowest steps:");
+  for (const ExecutedStep *step : sorted) {
+    puts(std::format("  {}  {}  {}", format_duration(step->duration_ms()),
+                     step->target, step->output)
+             .c_str());
+  }
+}
+
+void print_target_times(const std::vector<ExecutedStep> &steps,
+                        const size_t top_steps) {
+  struct TargetTime final {
+    std::string_view target;
+    uint64_t total_ms;
+    size_t num_steps;
+  };
+
+  std::map<std::string_view, TargetTime> per_target;
+  for (const ExecutedStep &step : steps) {
+    TargetTime &time = per_target
+                           .insert(std::pair{step.target,
+                                             TargetTime{step.target, 0, 0}})
+                           .first->second;
+    time.total_ms += step.duration_ms();
+    time.num_steps++;
+  }
+
+  std::vector<TargetTime> sorted;
+  for (const auto &[_, time] : per_target) {
+    sorted.push_back(time);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const TargetTime &lhs, const TargetTime &rhs) {
+              return lhs.total_ms > rhs.total_ms;
+            });
+  sorted.resize(std::min(sorted.size(), top_steps));
+
+  puts("Time per target:");
+  for (const TargetTime &time : sorted) {
+    puts(std::format("  {}  {} ({} steps)", format_duration(time.total_ms),
+                     time.target, time.num_steps)
+             .c_str());
+  }
+}
+
+} // namespace
+
+runtime::Result<void, std::string>
+report_build(const std::filesystem::path &build_dir,
+             const lua::ContextLib &contextlib,
+             const size_t top_steps) noexcept {
+  const std::vector<ninja::NinjaLogEntry> entries = RESULT_PROPAGATE(
+      ninja::load_ninja_log(build_dir / ninja::NINJA_LOG_FILE_NAME));
+  if (entries.empty()) {
+    puts("No build steps were executed in the last build");
+    return runtime::Result<void, std::string>::ok();
+  }
+
+  std::vector<ExecutedStep> steps = join_with_graph(entries, contextlib);
+
+  uint64_t first_start_ms = std::numeric_limits<uint64_t>::max();
+  uint64_t last_end_ms = 0;
+  uint64_t total_ms = 0;
+  for (const ExecutedStep &step : steps) {
+    first_start_ms = std::min(first_start_ms, step.start_ms);
+    last_end_ms = std::max(last_end_ms, step.end_ms);
+    total_ms += step.duration_ms();
+  }
+  const uint64_t wall_ms = last_end_ms - first_start_ms;
+
+  puts(std::format("Build report: {} steps, wall time {}", steps.size(),
+                   format_duration(wall_ms))
+           .c_str());
+  print_critical_path(steps, compute_critical_path(steps));
+  print_slowest_steps(steps, top_steps);
+  print_target_times(steps, top_steps);
+  // Average number of steps running at the same time
+  puts(std::format("Parallelism: {:.2f} (total step time {})",
+                   wall_ms == 0 ? 1.0
+                                : static_cast<double>(total_ms) /
+                                      static_cast<double>(wall_ms),
+                   format_duration(total_ms))
+           .c_str());
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::build
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <format>
+#include <string>
+#include <string_view>
+
+#include "yabt/build/target_matcher.h"
+
+namespace yabt::build {
+
+namespace {
+
+constexpr static std::string_view RECURSIVE_SUFFIX = "...";
+constexpr static std::string_view ANY_SUFFIX = ".*";
+constexpr static std::string_view SPECIAL_CHARS = "\\^$.|?*+()[]{}";
+constexpr static std::string_view QUANTIFIER_CHARS = "*?+{";
+
+[[nodiscard]] bool is_literal(const std::string_view pattern) noexcept {
+  return pattern.find_first_of(SPECIAL_CHARS) == std::string_view::npos;
+}
+
+// Literal text every match of the regular expression starts with
+[[nodiscard]] std::string_view
+regex_literal_prefix(const std::string_view pattern) noexcept {
+  if (pattern.find('|') != std::string_view::npos) {
+    return {};
+  }
+
+  const size_t special = pattern.find_first_of(SPECIAL_CHARS);
+  if (special == std::string_view::npos) {
+    return pattern;
+  }
+
+  // A quantifier applies to the character before it
+  if (special > 0 &&
+      QUANTIFIER_CHARS.find(pattern[special]) != std::string_view::npos) {
+    return pattern.substr(0, special - 1);
+  }
+  return pattern.substr(0, special);
+}
+
+} // namespace
+
+TargetMatcher::TargetMatcher() noexcept : m_trie(1) {}
+
+size_t TargetMatcher::insert_prefix(const std::string_view prefix) noexcept {
+  size_t node = 0;
+  for (const char c : prefix) {
+    const auto child = std::find_if(
+        m_trie[node].children.cbegin(), m_trie[node].children.cend(),
+        [c](const std::pair<char, size_t> &entry) { return entry.first == c; });
+    if (child != m_trie[node].children.cend()) {
+      node = child->second;
+      continue;
+    }
+
+    m_trie.emplace_back();
+    m_trie[node].children.emplace_back(c, m_trie.size() - 1);
+    node = m_trie.size() - 1;
+  }
+  return node;
+}
+
+runtime::Result<TargetMatcher, std::string> TargetMatcher::compile(
+    const std::span<const std::string_view> patterns) noexcept {
+  TargetMatcher matcher;
+  for (const std::string_view pattern : patterns) {
+    if (const std::string_view prefix =
+            pattern.substr(0, pattern.size() - RECURSIVE_SUFFIX.size());
+        pattern.ends_with(RECURSIVE_SUFFIX) && prefix.ends_with('/') &&
+        is_literal(prefix)) {
+      // The trailing slash is kept, so that //mod/a/... does not match //mod/ab
+      matcher.m_trie[matcher.insert_prefix(prefix)].matches_all = true;
+    } else if (const std::string_view prefix =
+                   pattern.substr(0, pattern.size() - ANY_SUFFIX.size());
+               pattern.ends_with(ANY_SUFFIX) && is_literal(prefix)) {
+      matcher.m_trie[matcher.insert_prefix(prefix)].matches_all = true;
+    } else if (is_literal(pattern)) {
+      matcher.m_exact.emplace(pattern);
+    } else {
+      try {
+        matcher.m_regexes.emplace_back(std::string{pattern},
+                                       std::regex::optimize);
+      } catch (const std::regex_error &error) {
+        return runtime::Result<TargetMatcher, std::string>::error(std::format(
+            "Invalid target pattern {}: {}", pattern, error.what()));
+      }
+      const size_t node = matcher.insert_prefix(regex_literal_prefix(pattern));
+      matcher.m_trie[node].regexes.push_back(matcher.m_regexes.size() - 1);
+    }
+  }
+
+  return runtime::Result<TargetMatcher, std::string>::ok(std::move(matcher));
+}
+
+std::vector<std::string> TargetMatcher::match(
+    const std::span<const std::string> targets) const noexcept {
+  std::vector<std::string> matched;
+  for (const std::string &target : targets) {
+    if (matches(target)) {
+      matched.push_back(target);
+    }
+  }
+  return matched;
+}
+
+bool TargetMatcher::matches(const std::string_view target) const noexcept {
+  if (!m_exact.empty() && m_exact.contains(std::string{target})) {
+    return true;
+  }
+
+  // Walk the trie along the target, only regular expressions whose literal
+  // prefix matches the target are tried.
+  size_t node = 0;
+  size_t depth = 0;
+  std::vector<size_t> candidates;
+  while (true) {
+    const TrieNode &current = m_trie[node];
+    if (current.matches_all) {
+      return true;
+    }
+    candidates.insert(candidates.end(), current.regexes.cbegin(),
+                      current.regexes.cend());
+
+    if (depth == target.size()) {
+      break;
+    }
+    const char c = target[depth++];
+    const auto child = std::find_if(
+        current.children.cbegin(), current.children.cend(),
+        [c](const std::pair<char, size_t> &entry) { return entry.first == c; });
+    if (child == current.children.cend()) {
+      break;
+    }
+    node = child->second;
+  }
+
+  return std::any_of(candidates.cbegin(), candidates.cend(), [&](size_t i) {
+    return std::regex_match(target.begin(), target.end(), m_regexes[i]);
+  });
+}
+
+} // namespace yabt::build
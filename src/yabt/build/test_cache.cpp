@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <fstream>
+#include <unistd.h>
+#include <vector>
+
+#include "yabt/build/test_cache.h"
+#include "yabt/utils/sha256.h"
+
+namespace yabt::build {
+
+namespace {
+
+// Bump when the key derivation changes, so that old entries are not reused
+constexpr static std::string_view KEY_VERSION = "yabt test cache v2";
+
+// Lengths are hashed too, so that the boundaries of strings are unambiguous
+void update_with_string(utils::Sha256 &hash, const std::string_view tag,
+                        const std::string_view value) noexcept {
+  hash.update(std::format("\n{} {}\n", tag, value.size()));
+  hash.update(value);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+update_with_contents(utils::Sha256 &hash,
+                     const std::filesystem::path &path) noexcept {
+  std::error_code error_code;
+  if (!std::filesystem::is_directory(path, error_code)) {
+    update_with_string(hash, "file", path.native());
+    const uintmax_t size = std::filesystem::file_size(path, error_code);
+    if (error_code) {
+      return runtime::Result<void, std::string>::error(std::format(
+          "Unable to read {}: {}", path.native(), error_code.message()));
+    }
+    hash.update(std::format("{}\n", size));
+    return utils::update_with_file(hash, path);
+  }
+
+  // Sorted, since directory iteration order is unspecified
+  std::vector<std::filesystem::path> entries;
+  for (std::filesystem::recursive_directory_iterator it{path, error_code};
+       !error_code && it != std::filesystem::recursive_directory_iterator{};
+       it.increment(error_code)) {
+    if (it->is_regular_file(error_code)) {
+      entries.push_back(it->path());
+    }
+  }
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Unable to list {}: {}", path.native(), error_code.message()));
+  }
+  std::sort(entries.begin(), entries.end());
+  for (const std::filesystem::path &entry : entries) {
+    RESULT_PROPAGATE_DISCARD(update_with_contents(hash, entry));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+update_with_status(utils::Sha256 &hash,
+                   const std::filesystem::path &path) noexcept {
+  std::error_code error_code;
+  const uintmax_t size = std::filesystem::file_size(path, error_code);
+  const std::filesystem::file_time_type time =
+      std::filesystem::last_write_time(path, error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Unable to read {}: {}", path.native(), error_code.message()));
+  }
+  update_with_string(hash, "built", path.native());
+  hash.update(
+      std::format("{} {}\n", size, time.time_since_epoch().count()));
+  return runtime::Result<void, std::string>::ok();
+}
+
+// Whether `path` is one of `inputs`, or inside one of them
+[[nodiscard]] bool is_input(const std::filesystem::path &path,
+                            const TestInputs &inputs) noexcept {
+  const auto contains = [&path](const std::filesystem::path &input) {
+    const std::filesystem::path relative = path.lexically_relative(input);
+    return !relative.empty() && *relative.begin() != "..";
+  };
+  return std::any_of(inputs.files.cbegin(), inputs.files.cend(), contains) ||
+         std::find(inputs.built_files.cbegin(), inputs.built_files.cend(),
+                   path) != inputs.built_files.cend();
+}
+
+// Checks that the files named in `arg`, or after the `=` of a `--flag=value`,
+// are part of the key
+[[nodiscard]] runtime::Result<void, std::string>
+check_argument(const std::string_view arg, const TestInputs &inputs) noexcept {
+  std::vector<std::string_view> candidates{arg};
+  if (const size_t equal = arg.find('='); equal != std::string_view::npos) {
+    candidates.push_back(arg.substr(equal + 1));
+  }
+  for (const std::string_view candidate : candidates) {
+    std::error_code error_code;
+    if (candidate.empty() ||
+        !std::filesystem::exists(candidate, error_code)) {
+      continue;
+    }
+    const std::filesystem::path path =
+        std::filesystem::absolute(candidate, error_code).lexically_normal();
+    if (error_code || !is_input(path, inputs)) {
+      return runtime::Result<void, std::string>::error(
+          std::format("{} is not declared as an input of the test", candidate));
+    }
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
+TestCache::TestCache(std::filesystem::path dir) noexcept
+    : m_dir{std::move(dir)} {}
+
+runtime::Result<std::string, std::string>
+TestCache::key(const TestInputs &inputs) const noexcept {
+  utils::Sha256 hash;
+  hash.update(KEY_VERSION);
+
+  for (const std::string &arg : inputs.argv) {
+    RESULT_PROPAGATE_DISCARD(check_argument(arg, inputs));
+    update_with_string(hash, "arg", arg);
+  }
+
+  // Tests inherit the whole environment of yabt
+  std::vector<std::string_view> env;
+  for (char **var = environ; *var != nullptr; var++) {
+    env.push_back(*var);
+  }
+  std::sort(env.begin(), env.end());
+  for (const std::string_view var : env) {
+    update_with_string(hash, "env", var);
+  }
+
+  for (const std::filesystem::path &file : inputs.files) {
+    RESULT_PROPAGATE_DISCARD(update_with_contents(hash, file));
+  }
+  for (const std::filesystem::path &file : inputs.built_files) {
+    RESULT_PROPAGATE_DISCARD(update_with_status(hash, file));
+  }
+
+  return runtime::Result<std::string, std::string>::ok(hash.hex_digest());
+}
+
+bool TestCache::has_passed(const std::string_view key) const noexcept {
+  std::error_code error_code;
+  return std::filesystem::exists(m_dir / key, error_code);
+}
+
+runtime::Result<void, std::string>
+TestCache::record_pass(const std::string_view key,
+                       const std::string_view target) const noexcept {
+  std::error_code error_code;
+  std::filesystem::create_directories(m_dir, error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to create {}: {}", m_dir.native(),
+                    error_code.message()));
+  }
+
+  // The entry only needs to exist, the target name helps debugging it
+  const std::filesystem::path entry = m_dir / key;
+  std::ofstream stream{entry};
+  stream << target << '\n';
+  if (!stream) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to write {}", entry.native()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::build
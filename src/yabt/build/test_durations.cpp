@@ -0,0 +1,56 @@
+#include <cstdlib>
+#include <format>
+#include <fstream>
+
+#include "yabt/build/test_durations.h"
+
+namespace yabt::build {
+
+namespace {
+
+constexpr static std::string_view FILE_HEADER = "# yabt test durations v1";
+
+} // namespace
+
+runtime::Result<TestDurations, std::string>
+load_test_durations(const std::filesystem::path &path) noexcept {
+  std::ifstream stream{path};
+  if (!stream.is_open()) {
+    return runtime::Result<TestDurations, std::string>::ok(TestDurations{});
+  }
+
+  std::string line;
+  if (!std::getline(stream, line) || line != FILE_HEADER) {
+    return runtime::Result<TestDurations, std::string>::error(
+        std::format("Unsupported test durations format in {}", path.native()));
+  }
+
+  // Each line holds the duration in milliseconds and the target, tab separated
+  TestDurations durations;
+  while (std::getline(stream, line)) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) {
+      continue;
+    }
+    durations[line.substr(tab + 1)] =
+        std::chrono::milliseconds{std::strtoll(line.c_str(), nullptr, 10)};
+  }
+  return runtime::Result<TestDurations, std::string>::ok(std::move(durations));
+}
+
+runtime::Result<void, std::string>
+save_test_durations(const std::filesystem::path &path,
+                    const TestDurations &durations) noexcept {
+  std::ofstream stream{path};
+  stream << FILE_HEADER << '\n';
+  for (const auto &[target, duration] : durations) {
+    stream << duration.count() << '\t' << target << '\n';
+  }
+  if (!stream) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to write {}", path.native()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::build
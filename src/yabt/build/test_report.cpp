@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+
+#include "yabt/build/test_report.h"
+#include "yabt/utils/string.h"
+
+namespace yabt::build {
+
+namespace {
+
+[[nodiscard]] double to_seconds(const std::chrono::microseconds time) {
+  return std::chrono::duration<double>{time}.count();
+}
+
+// The package of a target, used as the JUnit class name
+[[nodiscard]] std::string_view package_of(const std::string_view target) {
+  const size_t slash = target.rfind('/');
+  return slash == std::string_view::npos ? target : target.substr(0, slash);
+}
+
+template <typename Writer>
+[[nodiscard]] runtime::Result<void, std::string>
+write_report(const std::filesystem::path &path, const Writer &writer) {
+  std::error_code error_code;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error_code);
+  }
+
+  std::ofstream stream{path};
+  writer(stream);
+  if (!stream) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to write test report {}", path.native()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
+std::string
+describe_exit(const process::Process::ProcessOutput &output) noexcept {
+  if (output.timed_out) {
+    return "timed out";
+  }
+  if (const auto *exit =
+          std::get_if<process::Process::NormalExit>(&output.exit_reason)) {
+    return std::format("exit code {}", exit->exit_code);
+  }
+  const auto &signal =
+      std::get<process::Process::UnhandledSignal>(output.exit_reason);
+  return std::format("signal {}{}", signal.signal,
+                     signal.core_dumped ? " (core dumped)" : "");
+}
+
+runtime::Result<void, std::string>
+write_junit_report(const std::filesystem::path &path,
+                   const std::span<const ActionSummary> summaries) noexcept {
+  const size_t failures =
+      std::count_if(summaries.begin(), summaries.end(),
+                    [](const ActionSummary &s) { return !s.passed; });
+  std::chrono::microseconds total_time{};
+  for (const ActionSummary &summary : summaries) {
+    total_time += summary.resource_usage.wall_time;
+  }
+
+  return write_report(path, [&](std::ofstream &stream) {
+    stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    stream << std::format("<testsuites name=\"yabt\" tests=\"{}\" "
+                          "failures=\"{}\" time=\"{:.3f}\">\n",
+                          summaries.size(), failures, to_seconds(total_time));
+    stream << std::format("  <testsuite name=\"yabt test\" tests=\"{}\" "
+                          "failures=\"{}\" time=\"{:.3f}\">\n",
+                          summaries.size(), failures, to_seconds(total_time));
+
+    for (const ActionSummary &summary : summaries) {
+      const process::Process::ResourceUsage &usage = summary.resource_usage;
+      stream << std::format(
+          "    <testcase name=\"{}\" classname=\"{}\" time=\"{:.3f}\">\n",
+          utils::xml_escape(summary.target),
+          utils::xml_escape(package_of(summary.target)),
+          to_seconds(usage.wall_time));
+      stream << "      <properties>\n";
+      for (const auto &[name, value] : {
+               std::pair{"exit_reason", summary.exit_reason},
+               std::pair{"cached", std::string{summary.cached ? "true"
+                                                              : "false"}},
+               std::pair{"shards", std::format("{}", summary.shards)},
+               std::pair{"user_time",
+                         std::format("{:.3f}", to_seconds(usage.user_time))},
+               std::pair{"system_time",
+                         std::format("{:.3f}", to_seconds(usage.system_time))},
+               std::pair{"max_rss_kib", std::format("{}", usage.max_rss_kib)},
+           }) {
+        stream << std::format(
+            "        <property name=\"{}\" value=\"{}\"/>\n", name,
+            utils::xml_escape(value));
+      }
+      stream << "      </properties>\n";
+      if (!summary.passed) {
+        stream << std::format("      <failure message=\"{}\">{}</failure>\n",
+                              utils::xml_escape(summary.exit_reason),
+                              utils::xml_escape(summary.failure_output));
+      }
+      stream << "    </testcase>\n";
+    }
+
+    stream << "  </testsuite>\n";
+    stream << "</testsuites>\n";
+  });
+}
+
+runtime::Result<void, std::string>
+write_json_report(const std::filesystem::path &path,
+                  const std::span<const ActionSummary> summaries) noexcept {
+  const size_t failures =
+      std::count_if(summaries.begin(), summaries.end(),
+                    [](const ActionSummary &s) { return !s.passed; });
+
+  return write_report(path, [&](std::ofstream &stream) {
+    stream << "{\n";
+    stream << std::format("  \"passed\": {},\n", summaries.size() - failures);
+    stream << std::format("  \"failed\": {},\n", failures);
+    stream << "  \"targets\": [";
+    for (size_t i = 0; i < summaries.size(); i++) {
+      const ActionSummary &summary = summaries[i];
+      const process::Process::ResourceUsage &usage = summary.resource_usage;
+      stream << (i == 0 ? "\n" : ",\n");
+      stream << "    {\n";
+      stream << std::format("      \"target\": \"{}\",\n",
+                            utils::json_escape(summary.target));
+      stream << std::format("      \"passed\": {},\n", summary.passed);
+      stream << std::format("      \"cached\": {},\n", summary.cached);
+      stream << std::format("      \"shards\": {},\n", summary.shards);
+      stream << std::format("      \"exit_reason\": \"{}\",\n",
+                            utils::json_escape(summary.exit_reason));
+      stream << std::format("      \"wall_time_s\": {:.3f},\n",
+                            to_seconds(usage.wall_time));
+      stream << std::format("      \"user_time_s\": {:.3f},\n",
+                            to_seconds(usage.user_time));
+      stream << std::format("      \"system_time_s\": {:.3f},\n",
+                            to_seconds(usage.system_time));
+      stream << std::format("      \"max_rss_kib\": {}\n", usage.max_rss_kib);
+      stream << "    }";
+    }
+    stream << (summaries.empty() ? "]\n" : "\n  ]\n");
+    stream << "}\n";
+  });
+}
+
+} // namespace yabt::build
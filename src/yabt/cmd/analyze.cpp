@@ -0,0 +1,107 @@
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "yabt/build/build.h"
+#include "yabt/build/report.h"
+#include "yabt/cli/args.h"
+#include "yabt/cmd/analyze.h"
+#include "yabt/log/log.h"
+#include "yabt/runtime/result.h"
+#include "yabt/workspace/utils.h"
+
+namespace yabt::cmd {
+
+namespace {
+const std::string_view SHORT_DESCRIPTION =
+    "Analyzes where the time of the last build went";
+const std::string_view LONG_DESCRIPTION =
+    "Reads the ninja log of the last build and reports its critical path,\n"
+    "the slowest steps, the time spent per target and the parallelism\n"
+    "achieved.";
+
+[[nodiscard]] runtime::Result<void, std::string>
+analyze_inner(const std::optional<std::filesystem::path> &requested_build_dir,
+              const size_t top_steps) {
+  const std::optional<std::filesystem::path> ws_root =
+      workspace::get_workspace_root();
+  if (!ws_root.has_value()) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Could not find workspace root. Are you sure your "
+                    "directory tree contains a {} file?",
+                    module::MODULE_FILE_NAME));
+  }
+
+  const std::filesystem::path build_dir =
+      std::filesystem::absolute(requested_build_dir.value_or(
+          ws_root.value() / workspace::BUILD_DIR_NAME));
+
+  // The build graph is needed to know which target owns each step
+  auto modules = RESULT_PROPAGATE(workspace::open_workspace(ws_root.value()));
+  auto lua_modules =
+      build::construct_lua_modules(ws_root.value(), build_dir, modules);
+  auto lua_engine = RESULT_PROPAGATE(
+      build::prepare_lua_engine(ws_root.value(), *lua_modules, modules, {}));
+  RESULT_PROPAGATE_DISCARD(
+      build::invoke_rule_initializers(lua_engine, modules));
+  RESULT_PROPAGATE_DISCARD(build::invoke_build_targets(lua_engine, modules));
+
+  return build::report_build(build_dir, lua_modules->contextlib, top_steps);
+}
+
+} // namespace
+
+[[nodiscard]] runtime::Result<void, std::string>
+AnalyzeCommand::register_command(cli::CliParser &cli_parser) noexcept {
+  yabt::cli::Subcommand &subcommand = cli_parser.register_subcommand(
+      "analyze", *this, SHORT_DESCRIPTION, LONG_DESCRIPTION);
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"build-dir"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::STRING,
+      .description{"Overrides the build directory with the given path."},
+      .handler{[this](const cli::Arg &a) {
+        const cli::StringArg arg = std::get<cli::StringArg>(a);
+        this->m_build_dir = arg.value;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  return subcommand.register_flag({
+      .name{"top"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::INTEGER,
+      .description{"The number of steps and targets listed in the report"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
+        if (arg.value <= 0) {
+          return runtime::Result<void, std::string>::error(
+              "--top must be a positive number");
+        }
+        this->m_top_steps = static_cast<size_t>(arg.value);
+        return runtime::Result<void, std::string>::ok();
+      }},
+  });
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+AnalyzeCommand::handle_subcommand(
+    std::span<const std::string_view> unparsed_args) noexcept {
+  if (!unparsed_args.empty()) {
+    return runtime::Result<void, std::string>::error(
+        "analyze does not take any positional arguments");
+  }
+
+  if (runtime::Result result = analyze_inner(m_build_dir, m_top_steps);
+      result.is_error()) {
+    yabt_error("Analyze failed: {}", result.error_value());
+    exit(EXIT_FAILURE);
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::cmd
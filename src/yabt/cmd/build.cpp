@@ -30,7 +30,7 @@ BuildCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"The number of threads to use during the build process"},
       .handler{[this](const cli::Arg &a) {
         const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
-        this->m_threads = arg.value;
+        this->m_options.threads = arg.value;
         return runtime::Result<void, std::string>::ok();
       }},
   }));
@@ -43,19 +43,47 @@ BuildCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"Overrides the build directory with the given path."},
       .handler{[this](const cli::Arg &a) {
         const cli::StringArg arg = std::get<cli::StringArg>(a);
-        this->m_build_dir = arg.value;
+        this->m_options.build_dir = arg.value;
         return runtime::Result<void, std::string>::ok();
       }},
   }));
 
-  return subcommand.register_flag({
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
       .name{"compdb"},
       .short_name{},
       .optional = true,
       .type = yabt::cli::FlagType::BOOL,
       .description{"Generates a compilation database in the build directory"},
       .handler{[this](const cli::Arg &) {
-        this->m_compdb = true;
+        if (this->m_options.compdb == build::CompdbMode::None) {
+          this->m_options.compdb = build::CompdbMode::Single;
+        }
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"compdb-fragments"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::BOOL,
+      .description{"Like --compdb, but also writes one compilation database "
+                   "per source directory"},
+      .handler{[this](const cli::Arg &) {
+        this->m_options.compdb = build::CompdbMode::WithFragments;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  return subcommand.register_flag({
+      .name{"report"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::BOOL,
+      .description{"Reports the critical path, slowest steps and time spent "
+                   "per target after the build"},
+      .handler{[this](const cli::Arg &) {
+        this->m_options.report = true;
         return runtime::Result<void, std::string>::ok();
       }},
   });
@@ -64,8 +92,8 @@ BuildCommand::register_command(cli::CliParser &cli_parser) noexcept {
 [[nodiscard]] runtime::Result<void, std::string>
 BuildCommand::handle_subcommand(
     std::span<const std::string_view> target_patterns) noexcept {
-  if (runtime::Result result = build::execute_build(
-          m_threads, m_compdb, m_build_dir, target_patterns);
+  if (runtime::Result result =
+          build::execute_build(m_options, target_patterns);
       result.is_error()) {
     yabt_error("Build failed: {}", result.error_value());
     exit(EXIT_FAILURE);
@@ -1,9 +1,9 @@
-#include <regex>
 #include <span>
 #include <string>
 #include <string_view>
 
 #include "yabt/build/build.h"
+#include "yabt/build/target_matcher.h"
 #include "yabt/cmd/list.h"
 #include "yabt/log/log.h"
 #include "yabt/runtime/result.h"
@@ -40,25 +40,15 @@ list_inner(const std::span<const std::string_view> target_patterns) {
   RESULT_PROPAGATE_DISCARD(build::invoke_build_targets(lua_engine, modules));
 
   // Find all matching targets for a pattern
-  std::vector<std::regex> patterns;
-  for (const std::string_view target_pattern : target_patterns) {
-    patterns.emplace_back(std::string{target_pattern});
-  }
-
   std::vector<std::string> targets{};
   if (target_patterns.size() == 0) {
     for (const std::string &target : lua_modules->contextlib.all_targets) {
       targets.push_back(target);
     }
   } else {
-    for (const std::string &target : lua_modules->contextlib.all_targets) {
-      for (const std::regex &regex : patterns) {
-        if (std::regex_match(target, regex)) {
-          targets.push_back(target);
-          break; // don't add a target more than once
-        }
-      }
-    }
+    const build::TargetMatcher matcher =
+        RESULT_PROPAGATE(build::TargetMatcher::compile(target_patterns));
+    targets = matcher.match(lua_modules->contextlib.all_targets);
 
     if (targets.size() == 0) {
       yabt_error("No matched targets");
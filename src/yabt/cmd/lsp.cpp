@@ -14,6 +14,7 @@
 #include "yabt/module/module.h"
 #include "yabt/process/process.h"
 #include "yabt/runtime/result.h"
+#include "yabt/utils/string.h"
 #include "yabt/workspace/utils.h"
 
 namespace yabt::cmd {
@@ -26,35 +27,6 @@ const std::string_view LONG_DESCRIPTION =
     "Starts a language server for Yabt lua files in the current workspace.\n"
     "Any extra arguments are forwarded to lua-language-server.";
 
-// TODO: Probably should use a more comprehensive json escape implementation.
-[[nodiscard]] std::string
-json_escape(const std::string_view unscaped) noexcept {
-  std::string escaped;
-
-  escaped.reserve(unscaped.size());
-  for (const char c : unscaped) {
-    if (c == '"') {
-      escaped += "\\\"";
-    } else if (c == '\\') {
-      escaped += "\\\\";
-    } else if (c == '\b') {
-      escaped += "\\b";
-    } else if (c == '\r') {
-      escaped += "\\r";
-    } else if (c == '\n') {
-      escaped += "\\n";
-    } else if (c == '\f') {
-      escaped += "\\f";
-    } else if (c == '\t') {
-      escaped += "\\t";
-    } else {
-      escaped += c;
-    }
-  }
-
-  return escaped;
-}
-
 [[nodiscard]] std::string generate_luarc_json(
     const std::span<const std::filesystem::path> library_paths) noexcept {
   std::stringstream luarc_content;
@@ -67,7 +39,7 @@ json_escape(const std::string_view unscaped) noexcept {
 
   for (size_t i = 0; i < library_paths.size(); ++i) {
     luarc_content << "        \"";
-    luarc_content << json_escape(library_paths[i].string());
+    luarc_content << utils::json_escape(library_paths[i].string());
     luarc_content << '"';
     if (i < library_paths.size() - 1) {
       luarc_content << ',';
@@ -1,3 +1,6 @@
+#include <array>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -5,6 +8,7 @@
 #include "yabt/build/build.h"
 #include "yabt/cmd/rules_test.h"
 #include "yabt/process/process.h"
+#include "yabt/process/process_pool.h"
 #include "yabt/runtime/result.h"
 #include "yabt/workspace/utils.h"
 
@@ -17,21 +21,44 @@ const std::string_view SHORT_DESCRIPTION =
 const std::string_view LONG_DESCRIPTION =
     "Interact with the rules of the repository.";
 
-[[nodiscard]] runtime::Result<std::string, std::string>
-get_luarocks_path(const bool cpath) noexcept {
-  const char *type = "--lr-path";
-  if (cpath) {
-    type = "--lr-cpath";
+// Queries the Lua and C module paths from luarocks concurrently
+[[nodiscard]] runtime::Result<build::LuaPath, std::string>
+get_luarocks_path() noexcept {
+  constexpr static std::array<const char *, 2> TYPES{"--lr-path",
+                                                     "--lr-cpath"};
+
+  std::array<std::string, TYPES.size()> paths;
+  std::optional<std::string> error;
+
+  process::ProcessPool pool{TYPES.size()};
+  for (size_t i = 0; i < TYPES.size(); i++) {
+    pool.submit(
+        std::make_unique<process::Process>("luarocks", "path",
+                                           "--lua-version", "5.1", TYPES[i]),
+        true,
+        [&paths, &error, i](
+            runtime::Result<process::Process::ProcessOutput, std::string>
+                output) {
+          if (output.is_error()) {
+            error = output.error_value();
+          } else if (runtime::Result result = output.ok_value().to_result();
+                     result.is_error()) {
+            error = result.error_value();
+          } else {
+            paths[i] = output.ok_value().stdout.value_or("");
+          }
+        });
   }
+  RESULT_PROPAGATE_DISCARD(pool.run());
 
-  process::Process proc{"luarocks", "path", "--lua-version", "5.1", type};
-  RESULT_PROPAGATE_DISCARD(proc.start(true));
-
-  const auto output = proc.process_output();
-  RESULT_PROPAGATE_DISCARD(output.to_result());
-
-  return runtime::Result<std::string, std::string>::ok(
-      output.stdout.value_or(""));
+  if (error.has_value()) {
+    return runtime::Result<build::LuaPath, std::string>::error(
+        std::move(error.value()));
+  }
+  return runtime::Result<build::LuaPath, std::string>::ok(build::LuaPath{
+      .path{std::move(paths[0])},
+      .cpath{std::move(paths[1])},
+  });
 }
 
 } // namespace
@@ -65,10 +92,7 @@ RulesTestCommand::handle_subcommand(
       build::construct_lua_modules(ws_root.value(), build_dir, modules);
   auto lua_engine = RESULT_PROPAGATE(
       prepare_lua_engine(ws_root.value(), *lua_modules, modules,
-                         std::array{build::LuaPath{
-                             .path{RESULT_PROPAGATE(get_luarocks_path(false))},
-                             .cpath{RESULT_PROPAGATE(get_luarocks_path(true))},
-                         }}));
+                         std::array{RESULT_PROPAGATE(get_luarocks_path())}));
 
   std::vector<std::string> spec_dirs{};
   for (const auto &mod : modules) {
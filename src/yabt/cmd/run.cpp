@@ -1,3 +1,4 @@
+#include <chrono>
 #include <string>
 #include <string_view>
 
@@ -28,7 +29,24 @@ RunCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"The number of threads to use during the build process"},
       .handler{[this](const cli::Arg &a) {
         const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
-        this->m_threads = arg.value;
+        this->m_options.threads = arg.value;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"timeout"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::INTEGER,
+      .description{"Seconds each target may run before it is terminated"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
+        if (arg.value <= 0) {
+          return runtime::Result<void, std::string>::error(
+              "The timeout must be a positive number of seconds");
+        }
+        this->m_options.timeout = std::chrono::seconds{arg.value};
         return runtime::Result<void, std::string>::ok();
       }},
   }));
@@ -41,7 +59,7 @@ RunCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"Overrides the build directory with the given path."},
       .handler{[this](const cli::Arg &a) {
         const cli::StringArg arg = std::get<cli::StringArg>(a);
-        this->m_build_dir = arg.value;
+        this->m_options.build_dir = arg.value;
         return runtime::Result<void, std::string>::ok();
       }},
   });
@@ -66,7 +84,7 @@ RunCommand::register_command(cli::CliParser &cli_parser) noexcept {
   }
 
   if (const runtime::Result result =
-          build::execute_build(m_threads, false, m_build_dir, target_patterns,
+          build::execute_build(m_options, target_patterns,
                                build::PostBuildMode::Run, run_args);
       result.is_error()) {
     yabt_error("Run failed: {}", result.error_value());
@@ -5,6 +5,7 @@
 #include "yabt/cmd/sync.h"
 #include "yabt/log/log.h"
 #include "yabt/runtime/result.h"
+#include "yabt/utils/file.h"
 #include "yabt/workspace/utils.h"
 
 namespace yabt::cmd {
@@ -21,6 +22,55 @@ SyncCommand::register_command(cli::CliParser &cli_parser) noexcept {
   yabt::cli::Subcommand &subcommand = cli_parser.register_subcommand(
       "sync", *this, SHORT_DESCRIPTION, LONG_DESCRIPTION);
 
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"jobs"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::INTEGER,
+      .description{"The number of dependencies to fetch concurrently"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
+        if (arg.value <= 0) {
+          return runtime::Result<void, std::string>::error(
+              "The number of jobs must be positive");
+        }
+        this->m_jobs = static_cast<size_t>(arg.value);
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"git-cache"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::BOOL,
+      .description{"Clones git dependencies from mirrors, and downloads "
+                   "archives, into the user cache directory shared by all "
+                   "workspaces"},
+      .handler{[this](const cli::Arg &) {
+        this->m_cache_dir = utils::user_cache_dir();
+        if (!this->m_cache_dir.has_value()) {
+          return runtime::Result<void, std::string>::error(
+              "Unable to find the user cache directory: neither "
+              "XDG_CACHE_HOME nor HOME are set");
+        }
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"locked"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::BOOL,
+      .description{"Syncs the dependencies recorded in MODULE.lock without "
+                   "resolving them again"},
+      .handler{[this](const cli::Arg &) {
+        this->m_sync_mode = workspace::SyncMode::LOCKED;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
   return subcommand.register_flag({
       .name{"strict"},
       .short_name{},
@@ -29,7 +79,10 @@ SyncCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"Refuses to sync if any of the dependencies are not pinned "
                    "with a hash"},
       .handler{[this](const cli::Arg &) {
-        this->m_sync_mode = workspace::SyncMode::STRICT;
+        // A locked sync is already strict
+        if (this->m_sync_mode != workspace::SyncMode::LOCKED) {
+          this->m_sync_mode = workspace::SyncMode::STRICT;
+        }
         return runtime::Result<void, std::string>::ok();
       }},
   });
@@ -52,7 +105,8 @@ SyncCommand::register_command(cli::CliParser &cli_parser) noexcept {
   }
 
   const runtime::Result result =
-      workspace::sync_workspace(ws_root.value(), m_sync_mode);
+      workspace::sync_workspace(ws_root.value(), m_sync_mode, m_jobs,
+                                m_cache_dir);
   if (!result.is_ok()) {
     yabt_error("Error syncing dependencies: {}", result.error_value());
   } else {
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <string>
 #include <string_view>
 
@@ -28,7 +29,80 @@ TestCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"The number of threads to use during the build process"},
       .handler{[this](const cli::Arg &a) {
         const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
-        this->m_threads = arg.value;
+        this->m_options.threads = arg.value;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"jobs"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::INTEGER,
+      .description{"The number of tests to run concurrently. Defaults to the "
+                   "number of cores"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
+        if (arg.value <= 0) {
+          return runtime::Result<void, std::string>::error(
+              "The number of jobs must be positive");
+        }
+        this->m_options.test_jobs = static_cast<size_t>(arg.value);
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"no-cache"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::BOOL,
+      .description{"Runs every test, even those that passed before"},
+      .handler{[this](const cli::Arg &) {
+        this->m_options.test_cache = false;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"junit"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::STRING,
+      .description{"Writes the test results to the given path as JUnit XML"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::StringArg arg = std::get<cli::StringArg>(a);
+        this->m_options.junit_report = arg.value;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"json"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::STRING,
+      .description{"Writes the test results to the given path as JSON"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::StringArg arg = std::get<cli::StringArg>(a);
+        this->m_options.json_report = arg.value;
+        return runtime::Result<void, std::string>::ok();
+      }},
+  }));
+
+  RESULT_PROPAGATE_DISCARD(subcommand.register_flag({
+      .name{"timeout"},
+      .short_name{},
+      .optional = true,
+      .type = yabt::cli::FlagType::INTEGER,
+      .description{"Seconds each test may run before it is terminated"},
+      .handler{[this](const cli::Arg &a) {
+        const cli::IntegerArg arg = std::get<cli::IntegerArg>(a);
+        if (arg.value <= 0) {
+          return runtime::Result<void, std::string>::error(
+              "The timeout must be a positive number of seconds");
+        }
+        this->m_options.timeout = std::chrono::seconds{arg.value};
         return runtime::Result<void, std::string>::ok();
       }},
   }));
@@ -41,7 +115,7 @@ TestCommand::register_command(cli::CliParser &cli_parser) noexcept {
       .description{"Overrides the build directory with the given path."},
       .handler{[this](const cli::Arg &a) {
         const cli::StringArg arg = std::get<cli::StringArg>(a);
-        this->m_build_dir = arg.value;
+        this->m_options.build_dir = arg.value;
         return runtime::Result<void, std::string>::ok();
       }},
   });
@@ -66,7 +140,7 @@ TestCommand::register_command(cli::CliParser &cli_parser) noexcept {
   }
 
   if (const runtime::Result result =
-          build::execute_build(m_threads, false, m_build_dir, target_patterns,
+          build::execute_build(m_options, target_patterns,
                                build::PostBuildMode::Test, test_args);
       result.is_error()) {
     yabt_error("Test failed: {}", result.error_value());
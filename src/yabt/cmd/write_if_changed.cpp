@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/cmd/write_if_changed.h"
+#include "yabt/log/log.h"
+#include "yabt/process/process.h"
+#include "yabt/runtime/result.h"
+#include "yabt/utils/file.h"
+
+namespace yabt::cmd {
+
+namespace {
+
+const std::string_view SHORT_DESCRIPTION =
+    "Runs a command, preserving outputs whose content did not change";
+const std::string_view LONG_DESCRIPTION =
+    "Usage: write-if-changed <output>... -- <command> [args...]\n\n"
+    "Runs the given command. Every listed output that is regenerated with\n"
+    "the same content it had before keeps its previous timestamp. Combined\n"
+    "with `restat = true` in a build rule or step, ninja skips rebuilding\n"
+    "everything that depends on an output that did not change.";
+
+constexpr static std::string_view BACKUP_SUFFIX = ".yabt-prev";
+
+struct BackedUpOutput final {
+  std::filesystem::path output;
+  std::filesystem::path backup;
+};
+
+[[nodiscard]] runtime::Result<std::vector<BackedUpOutput>, std::string>
+backup_outputs(const std::span<const std::string_view> outputs) noexcept {
+  std::vector<BackedUpOutput> backups;
+  for (const std::string_view output : outputs) {
+    const std::filesystem::path output_path{output};
+    std::error_code error_code;
+    if (!std::filesystem::is_regular_file(output_path, error_code)) {
+      continue;
+    }
+
+    std::filesystem::path backup_path = output_path;
+    backup_path += BACKUP_SUFFIX;
+    std::filesystem::rename(output_path, backup_path, error_code);
+    if (error_code) {
+      return runtime::Result<std::vector<BackedUpOutput>, std::string>::error(
+          std::format("Unable to back up {}: {}", output_path.native(),
+                      error_code.message()));
+    }
+    backups.push_back({.output{output_path}, .backup{backup_path}});
+  }
+  return runtime::Result<std::vector<BackedUpOutput>, std::string>::ok(
+      std::move(backups));
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+restore_unchanged_outputs(const std::span<const BackedUpOutput> backups) {
+  for (const BackedUpOutput &backup : backups) {
+    const bool unchanged = RESULT_PROPAGATE(
+        utils::files_have_same_content(backup.output, backup.backup));
+
+    std::error_code error_code;
+    if (unchanged) {
+      // Putting the old file back restores its modification time, which is
+      // what ninja looks at when re-stating the outputs.
+      yabt_verbose("Output {} did not change", backup.output.native());
+      std::filesystem::rename(backup.backup, backup.output, error_code);
+    } else {
+      std::filesystem::remove(backup.backup, error_code);
+    }
+
+    if (error_code) {
+      return runtime::Result<void, std::string>::error(
+          std::format("Unable to restore {}: {}", backup.output.native(),
+                      error_code.message()));
+    }
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+void discard_backups(const std::span<const BackedUpOutput> backups) {
+  for (const BackedUpOutput &backup : backups) {
+    std::error_code error_code;
+    std::filesystem::remove(backup.backup, error_code);
+  }
+}
+
+} // namespace
+
+[[nodiscard]] runtime::Result<void, std::string>
+WriteIfChangedCommand::register_command(cli::CliParser &cli_parser) noexcept {
+  yabt::cli::Subcommand &subcommand = cli_parser.register_subcommand(
+      "write-if-changed", *this, SHORT_DESCRIPTION, LONG_DESCRIPTION);
+  static_cast<void>(subcommand);
+  return runtime::Result<void, std::string>::ok();
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+WriteIfChangedCommand::handle_subcommand(
+    std::span<const std::string_view> unparsed_args) noexcept {
+  using std::string_view_literals::operator""sv;
+  const auto separator =
+      std::find(unparsed_args.begin(), unparsed_args.end(), "--"sv);
+  if (separator == unparsed_args.end()) {
+    return runtime::Result<void, std::string>::error(
+        "write-if-changed expects the command after a \"--\" separator");
+  }
+
+  const size_t pos = separator - unparsed_args.begin();
+  const std::span<const std::string_view> outputs =
+      unparsed_args.subspan(0, pos);
+  const std::span<const std::string_view> command =
+      unparsed_args.subspan(pos + 1);
+  if (outputs.size() == 0 || command.size() == 0) {
+    return runtime::Result<void, std::string>::error(
+        "write-if-changed expects at least one output and a command");
+  }
+
+  const std::vector<BackedUpOutput> backups =
+      RESULT_PROPAGATE(backup_outputs(outputs));
+
+  std::vector<std::string> args;
+  for (const std::string_view arg : command.subspan(1)) {
+    args.emplace_back(arg);
+  }
+
+  process::Process proc{command[0], std::span<const std::string>{args}};
+  if (const runtime::Result result = proc.start(); result.is_error()) {
+    discard_backups(backups);
+    return result;
+  }
+
+  const process::Process::ProcessOutput output = proc.process_output();
+  if (const auto *normal_exit =
+          std::get_if<process::Process::NormalExit>(&output.exit_reason);
+      normal_exit == nullptr || normal_exit->exit_code != 0) {
+    // A failed command leaves its outputs in an unknown state. Let ninja
+    // rebuild them next time instead of restoring stale files.
+    discard_backups(backups);
+    exit(normal_exit != nullptr ? normal_exit->exit_code : EXIT_FAILURE);
+  }
+
+  if (const runtime::Result result = restore_unchanged_outputs(backups);
+      result.is_error()) {
+    discard_backups(backups);
+    return result;
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::cmd
@@ -9,6 +9,7 @@
 ---@field descr? string      Human-readable description shown during build.
 ---@field variables? table<string, string>  Extra ninja default rule variables (e.g. depfile).
 ---@field compdb? boolean    Whether this rule should appear in compile_commands.json.
+---@field restat? boolean    Whether ninja re-stats the outputs after running the rule, skipping dependents of unchanged outputs.
 
 ---@class BuildStep
 ---@field outs OutPath[]     Resulting paths out of the compilation process.
@@ -16,6 +17,7 @@
 ---@field cmd string         The command to build the outputs.
 ---@field descr? string      Human-readable description shown during build.
 ---@field variables? table<string, string> Extra ninja variables used in the generated rule.
+---@field restat? boolean    Whether ninja re-stats the outputs after running the step, skipping dependents of unchanged outputs.
 
 ---@class BuildStepWithRule
 ---@field outs OutPath[]     Resulting paths out of the compilation process.
@@ -28,6 +30,10 @@
 ---@field add_build_step_with_rule fun(step: BuildStepWithRule, rule: BuildRule)    Registers a build step with a generic rule in the global context.
 ---@field register_run_fn fun(fn: fun(args: string[]): string[])    Registers a runnable for a given target
 ---@field register_test_fn fun(fn: fun(args: string[]): string[])   Registers a testable for a given target.
+---@field set_timeout fun(seconds: number)   Sets how long the run or test process of the current target may take before it is terminated.
+---@field set_shardable fun()   Marks the test of the current target as splittable in shards through the GTEST_TOTAL_SHARDS and GTEST_SHARD_INDEX environment variables.
+---@field set_runtime_inputs fun(paths: Path[])   Declares the files the test of the current target reads besides the target's outputs. Only tests of targets declaring them are cached.
+---@field yabt_executable fun(): string   Returns the absolute path of the running yabt executable.
 
 ---@type Context
 local M
@@ -11,4 +11,30 @@ function M.table_contains(table, elem)
     return false
 end
 
+---@param s string
+---@return string
+local function shell_quote(s)
+    return "'" .. string.gsub(s, "'", "'\\''") .. "'"
+end
+
+--- Wraps a shell command so that outputs regenerated with identical content keep
+--- their previous timestamps. Use it together with `restat = true` in the rule or
+--- step, so that ninja skips everything depending on unchanged outputs.
+---@param outs (OutPath|string)[] Outputs of the command. Strings are used verbatim (e.g. '$out').
+---@param cmd string The shell command that generates the outputs.
+---@return string
+function M.write_if_changed(outs, cmd)
+    local ctx = require 'yabt.core.context'
+    local quoted_outs = {}
+    for _, out in ipairs(outs) do
+        if type(out) == 'string' then
+            table.insert(quoted_outs, out)
+        else
+            table.insert(quoted_outs, shell_quote(out:absolute()))
+        end
+    end
+    return shell_quote(ctx.yabt_executable()) .. ' write-if-changed ' .. table.concat(quoted_outs, ' ') ..
+        ' -- /bin/sh -c ' .. shell_quote(cmd)
+end
+
 return M
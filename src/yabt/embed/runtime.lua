@@ -174,6 +174,15 @@ local function handle_target(target_spec_path, target_name, target)
         if target.test and type(target.test) == 'function' then
             ctx.register_test_fn(function(args) return target:test(args) end)
         end
+        if target.timeout ~= nil then
+            ctx.set_timeout(target.timeout)
+        end
+        if target.shardable then
+            ctx.set_shardable()
+        end
+        if target.data ~= nil then
+            ctx.set_runtime_inputs(target.data)
+        end
     end)
     if not ok then
         log.error('Error executing build for //' .. target_spec_path .. '/' .. target_name .. ': ' .. err)
@@ -1,6 +1,7 @@
 #include "yabt/lua/context_lib.h"
 
 #include <cstring>
+#include <filesystem>
 
 #include "yabt/log/log.h"
 #include "yabt/lua/utils.h"
@@ -29,6 +30,15 @@ ContextLib *get_lib_from_registry(lua_State *const L) {
   return lib;
 }
 
+void record_output_target(ContextLib &lib, const std::vector<OutPath> &outs) {
+  if (lib.current_target.empty()) {
+    return;
+  }
+  for (const OutPath &out : outs) {
+    lib.output_targets.insert(std::pair{out.path, lib.current_target});
+  }
+}
+
 runtime::Result<void, std::string> add_build_step_impl(ContextLib &lib) {
   if (lua_gettop(lib.state) != 1) {
     return runtime::Result<void, std::string>::error(
@@ -57,6 +67,7 @@ runtime::Result<void, std::string> add_build_step_impl(ContextLib &lib) {
         std::pair{step.outs.front().path, lib.build_steps.size() - 1});
     yabt_verbose("Registered build step for: {} with cmd: {}",
                  step.outs[0].path, step.cmd);
+    record_output_target(lib, step.outs);
   }
 
   for (const OutPath &out : step.outs) {
@@ -133,6 +144,7 @@ add_build_step_with_rule_impl(ContextLib &lib) {
         step.outs.front().path, lib.build_steps_with_rule.size() - 1});
     yabt_verbose("Registered build step for: {} with rule: {}",
                  step.outs[0].path, step.rule_name);
+    record_output_target(lib, step.outs);
   }
 
   for (const OutPath &out : step.outs) {
@@ -265,12 +277,107 @@ int l_register_test_fn(lua_State *const L) {
   return 0;
 }
 
+int l_set_timeout(lua_State *const L) {
+  StackGuard g{L, 0}; // 1 input arg, 0 outputs
+  ContextLib *const lib = get_lib_from_registry(L);
+  runtime::check(lib != nullptr, "Context lib is NULL");
+  if (lua_gettop(L) != 1 || !lua_isnumber(L, 1) || lua_tonumber(L, 1) <= 0) {
+    lua_pushstring(L, "set_timeout expects a positive number of seconds");
+    lua_error(L);
+  }
+  runtime::check(lib->current_target.size() > 0,
+                 "No current target while setting a timeout");
+  const double seconds = lua_tonumber(L, 1);
+  lib->target_timeouts[lib->current_target] =
+      std::chrono::milliseconds{static_cast<int64_t>(seconds * 1000)};
+  return 0;
+}
+
+int l_set_shardable(lua_State *const L) {
+  StackGuard g{L, 0}; // 0 input args, 0 outputs
+  ContextLib *const lib = get_lib_from_registry(L);
+  runtime::check(lib != nullptr, "Context lib is NULL");
+  runtime::check(lib->current_target.size() > 0,
+                 "No current target while marking it as shardable");
+  lib->shardable_targets.insert(lib->current_target);
+  return 0;
+}
+
+runtime::Result<void, std::string> set_runtime_inputs_impl(ContextLib &lib) {
+  if (lua_gettop(lib.state) != 1) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Expected 1 argument to set_runtime_inputs, but got: {}",
+                    lua_gettop(lib.state)));
+  }
+  runtime::check(lib.current_target.size() > 0,
+                 "No current target while setting runtime inputs");
+
+  const std::vector<Path> paths =
+      RESULT_PROPAGATE(parse_lua_object<std::vector<Path>>(lib.state));
+  std::vector<std::string> &inputs =
+      lib.target_runtime_inputs[lib.current_target];
+  for (const Path &path : paths) {
+    inputs.push_back(path.path);
+  }
+
+  lua_pop(lib.state, 1);
+  return runtime::Result<void, std::string>::ok();
+}
+
+void set_runtime_inputs(ContextLib &lib) {
+  {
+    const runtime::Result result = set_runtime_inputs_impl(lib);
+    if (result.is_ok()) {
+      return;
+    }
+
+    lua_pushstring(lib.state, result.error_value().c_str());
+  }
+
+  // This call does longjmp, which breaks destructors of data types, since they
+  // do not get executed. That's why the data above is in a different block
+  lua_error(lib.state);
+}
+
+int l_set_runtime_inputs(lua_State *const L) {
+  StackGuard g{L, -1}; // 1 input arg, 0 outputs
+  ContextLib *const lib = get_lib_from_registry(L);
+  runtime::check(lib != nullptr, "Context lib is NULL");
+  set_runtime_inputs(*lib);
+  return 0;
+}
+
+int l_yabt_executable(lua_State *const L) {
+  StackGuard g{L, 1}; // 0 input args, 1 output
+  {
+    std::error_code error_code;
+    const std::filesystem::path exe =
+        std::filesystem::read_symlink("/proc/self/exe", error_code);
+    if (!error_code) {
+      lua_pushstring(L, exe.c_str());
+      return 1;
+    }
+    lua_pushstring(L, std::format("Unable to find the yabt executable: {}",
+                                  error_code.message())
+                          .c_str());
+  }
+
+  // This call does longjmp, which breaks destructors of data types, since they
+  // do not get executed. That's why the data above is in a different block
+  lua_error(L);
+  return 0;
+}
+
 static const luaL_Reg context_functions[]{
     {"add_build_step", l_add_build_step},                     //
     {"add_build_step_with_rule", l_add_build_step_with_rule}, //
     {"handle_target", l_handle_target},                       //
     {"register_run_fn", l_register_run_fn},                   //
     {"register_test_fn", l_register_test_fn},                 //
+    {"set_timeout", l_set_timeout},                           //
+    {"set_shardable", l_set_shardable},                       //
+    {"set_runtime_inputs", l_set_runtime_inputs},             //
+    {"yabt_executable", l_yabt_executable},                   //
     {nullptr, nullptr},                                       //
 };
 
@@ -331,6 +438,10 @@ ContextLib::ContextLib(ContextLib &&other)
       all_targets{std::move(other.all_targets)},
       run_fn_refs{std::move(other.run_fn_refs)},
       test_fn_refs{std::move(other.test_fn_refs)},
+      output_targets{std::move(other.output_targets)},
+      target_timeouts{std::move(other.target_timeouts)},
+      shardable_targets{std::move(other.shardable_targets)},
+      target_runtime_inputs{std::move(other.target_runtime_inputs)},
 
       state{other.state}, current_target{std::move(other.current_target)},
       leaf_paths{std::move(other.leaf_paths)} {
@@ -345,6 +456,10 @@ ContextLib &ContextLib::operator=(ContextLib &&other) {
     all_targets = std::move(other.all_targets);
     run_fn_refs = std::move(other.run_fn_refs);
     test_fn_refs = std::move(other.test_fn_refs);
+    output_targets = std::move(other.output_targets);
+    target_timeouts = std::move(other.target_timeouts);
+    shardable_targets = std::move(other.shardable_targets);
+    target_runtime_inputs = std::move(other.target_runtime_inputs);
 
     state = {other.state};
     current_target = std::move(other.current_target);
@@ -1,6 +1,7 @@
 #include <string>
 
 #include "yabt/cli/cli_parser.h"
+#include "yabt/cmd/analyze.h"
 #include "yabt/cmd/build.h"
 #include "yabt/cmd/clean.h"
 #include "yabt/cmd/help.h"
@@ -10,6 +11,7 @@
 #include "yabt/cmd/run.h"
 #include "yabt/cmd/sync.h"
 #include "yabt/cmd/test.h"
+#include "yabt/cmd/write_if_changed.h"
 #include "yabt/log/log.h"
 #include "yabt/runtime/check_result.h"
 
@@ -70,6 +72,8 @@ yabt::cmd::CleanCommand clean_cmd;
 yabt::cmd::ListCommand list_cmd;
 yabt::cmd::TestCommand test_cmd;
 yabt::cmd::RulesTestCommand rules_cmd;
+yabt::cmd::WriteIfChangedCommand write_if_changed_cmd;
+yabt::cmd::AnalyzeCommand analyze_cmd;
 
 void register_subcommands(yabt::cli::CliParser &cli_parser) {
   yabt::runtime::check(build_cmd.register_command(cli_parser),
@@ -90,6 +94,10 @@ void register_subcommands(yabt::cli::CliParser &cli_parser) {
                        "Unable to register test command: {}");
   yabt::runtime::check(rules_cmd.register_command(cli_parser),
                        "Unable to register rules_test command: {}");
+  yabt::runtime::check(write_if_changed_cmd.register_command(cli_parser),
+                       "Unable to register write-if-changed command: {}");
+  yabt::runtime::check(analyze_cmd.register_command(cli_parser),
+                       "Unable to register analyze command: {}");
 }
 
 } // namespace
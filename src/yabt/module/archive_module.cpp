@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/log/log.h"
+#include "yabt/module/archive_module.h"
+#include "yabt/process/process.h"
+#include "yabt/runtime/result.h"
+#include "yabt/utils/file.h"
+#include "yabt/utils/sha256.h"
+#include "yabt/utils/string.h"
+
+namespace yabt::module {
+
+namespace {
+
+// Runs the command, prefixing its errors with what it was doing
+template <typename... Args>
+runtime::Result<void, std::string>
+exec_command(std::string_view what, std::string_view executable,
+             Args &&...args) noexcept {
+  process::Process proc{executable, std::forward<Args>(args)...};
+  RESULT_PROPAGATE_DISCARD(proc.start(true));
+  if (runtime::Result result = proc.process_output().to_result();
+      result.is_error()) {
+    return runtime::Result<void, std::string>::error(
+        std::format("{}: {}", what, result.error_value()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+// Hashes are compared in lowercase, like Sha256::hex_digest produces them
+[[nodiscard]] std::string lowercase(std::string_view text) noexcept {
+  std::string lower{text};
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](const unsigned char c) { return std::tolower(c); });
+  return lower;
+}
+
+[[nodiscard]] bool is_sha256(std::string_view hash) noexcept {
+  return hash.size() == 64 &&
+         std::all_of(hash.cbegin(), hash.cend(), [](const char c) {
+           return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+         });
+}
+
+[[nodiscard]] std::string
+read_marker(const std::filesystem::path &mod_dir) noexcept {
+  std::ifstream stream{mod_dir / ARCHIVE_MARKER_FILE_NAME};
+  std::string hash;
+  std::getline(stream, hash);
+  return std::string{utils::trim_whitespace(hash)};
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+download(std::string_view url, const std::filesystem::path &dest) noexcept {
+  constexpr static std::string_view FILE_SCHEME = "file://";
+  if (url.starts_with(FILE_SCHEME) || url.find("://") == std::string::npos) {
+    const std::filesystem::path source =
+        url.starts_with(FILE_SCHEME) ? url.substr(FILE_SCHEME.size()) : url;
+    std::error_code error_code;
+    std::filesystem::copy_file(
+        source, dest, std::filesystem::copy_options::overwrite_existing,
+        error_code);
+    if (error_code) {
+      return runtime::Result<void, std::string>::error(std::format(
+          "Unable to copy {}: {}", source.native(), error_code.message()));
+    }
+    return runtime::Result<void, std::string>::ok();
+  }
+
+  return exec_command(std::format("Unable to download {}", url), "curl",
+                      "--fail", "--silent", "--show-error", "--location",
+                      "--output", dest.native(), url);
+}
+
+// Returns the path of the archive in the cache, downloading it if it is not
+// there yet. Archives only enter the cache once their hash is verified.
+[[nodiscard]] runtime::Result<std::filesystem::path, std::string>
+fetch_archive(const std::filesystem::path &cache_dir, std::string_view url,
+              std::string_view hash) noexcept {
+  const std::filesystem::path archives_dir =
+      cache_dir / ARCHIVE_CACHE_DIR_NAME;
+  std::error_code error_code;
+  std::filesystem::create_directories(archives_dir, error_code);
+  if (error_code) {
+    return runtime::Result<std::filesystem::path, std::string>::error(
+        std::format("Unable to create archive cache at {}: {}",
+                    archives_dir.native(), error_code.message()));
+  }
+
+  const std::filesystem::path archive = archives_dir / hash;
+  const utils::FileLock _lock =
+      RESULT_PROPAGATE(utils::FileLock::acquire(archive.native() + ".lock"));
+  if (std::filesystem::exists(archive)) {
+    yabt_debug("Found archive {} in the cache", hash);
+    return runtime::Result<std::filesystem::path, std::string>::ok(archive);
+  }
+
+  const std::filesystem::path partial = archive.native() + ".partial";
+  yabt_verbose("Downloading {}", url);
+  RESULT_PROPAGATE_DISCARD(download(url, partial));
+
+  utils::Sha256 sha256;
+  RESULT_PROPAGATE_DISCARD(utils::update_with_file(sha256, partial));
+  if (const std::string actual_hash = sha256.hex_digest();
+      actual_hash != hash) {
+    std::filesystem::remove(partial, error_code);
+    return runtime::Result<std::filesystem::path, std::string>::error(
+        std::format("Archive {} has hash {}, but {} was expected", url,
+                    actual_hash, hash));
+  }
+
+  std::filesystem::rename(partial, archive, error_code);
+  if (error_code) {
+    return runtime::Result<std::filesystem::path, std::string>::error(
+        std::format("Unable to move archive to {}: {}", archive.native(),
+                    error_code.message()));
+  }
+  return runtime::Result<std::filesystem::path, std::string>::ok(archive);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+extract(const std::filesystem::path &archive, std::string_view url,
+        const std::filesystem::path &dest) noexcept {
+  std::error_code error_code;
+  std::filesystem::create_directories(dest, error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Unable to create {}: {}", dest.native(), error_code.message()));
+  }
+
+  // Cached archives are named after their hash, so the format comes from
+  // the url. tar detects the compression by itself.
+  const std::string what = std::format("Unable to extract {}", url);
+  RESULT_PROPAGATE_DISCARD(
+      url.ends_with(".zip") ? exec_command(what, "unzip", "-q",
+                                           archive.native(), "-d",
+                                           dest.native())
+                            : exec_command(what, "tar", "-xf",
+                                           archive.native(), "-C",
+                                           dest.native()));
+
+  // Hoist the contents of a single top-level directory
+  std::filesystem::directory_iterator entries{dest, error_code};
+  const std::vector<std::filesystem::directory_entry> top_level{
+      begin(entries), end(entries)};
+  if (top_level.size() != 1 || !top_level.front().is_directory()) {
+    return runtime::Result<void, std::string>::ok();
+  }
+
+  const std::filesystem::path nested = dest.native() + ".nested";
+  std::filesystem::rename(top_level.front().path(), nested, error_code);
+  if (!error_code) {
+    std::filesystem::remove(dest, error_code);
+  }
+  if (!error_code) {
+    std::filesystem::rename(nested, dest, error_code);
+  }
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to move the contents of {} to {}: {}",
+                    top_level.front().path().native(), dest.native(),
+                    error_code.message()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
+runtime::Result<std::unique_ptr<Module>, std::string>
+ArchiveModule::open(std::filesystem::path mod_dir) noexcept {
+  if (!std::filesystem::exists(mod_dir / ARCHIVE_MARKER_FILE_NAME)) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error("");
+  }
+
+  std::string hash = read_marker(mod_dir);
+  return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
+      std::unique_ptr<Module>{new ArchiveModule{mod_dir, std::move(hash)}});
+}
+
+runtime::Result<std::unique_ptr<Module>, std::string>
+ArchiveModule::open_or_fetch_module(const std::filesystem::path &mod_dir,
+                                    std::string_view mod_url,
+                                    std::string_view mod_hash,
+                                    const std::optional<std::filesystem::path>
+                                        &cache_dir) noexcept {
+  if (mod_hash.empty()) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("Archive {} has no hash. Archives are only used once "
+                    "their SHA-256 is known",
+                    mod_url));
+  }
+
+  // The hash names the archive in the shared cache, so it must not be able
+  // to point anywhere else
+  const std::string hash = lowercase(mod_hash);
+  if (!is_sha256(hash)) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("Archive {} has hash {}, which is not a SHA-256 hex digest",
+                    mod_url, mod_hash));
+  }
+
+  if (std::filesystem::exists(mod_dir / ARCHIVE_MARKER_FILE_NAME) &&
+      read_marker(mod_dir) == hash) {
+    yabt_debug("Opening already-extracted archive module at {}",
+               mod_dir.native());
+    return ArchiveModule::open(mod_dir);
+  }
+
+  // Without a shared cache, archives are kept next to the modules
+  const std::filesystem::path archive = RESULT_PROPAGATE(fetch_archive(
+      cache_dir.value_or(mod_dir.parent_path()), mod_url, hash));
+
+  // Extracted aside, so that an interrupted extraction is not taken for the
+  // module
+  const std::filesystem::path partial_dir = mod_dir.native() + ".partial";
+  std::error_code error_code;
+  std::filesystem::remove_all(partial_dir, error_code);
+  RESULT_PROPAGATE_DISCARD(extract(archive, mod_url, partial_dir));
+  std::ofstream{partial_dir / ARCHIVE_MARKER_FILE_NAME} << hash << '\n';
+
+  std::filesystem::remove_all(mod_dir, error_code);
+  if (!error_code) {
+    std::filesystem::rename(partial_dir, mod_dir, error_code);
+  }
+  if (error_code) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("Unable to move archive module to {}: {}",
+                    mod_dir.native(), error_code.message()));
+  }
+
+  yabt_debug("Successfully extracted archive module at {}", mod_dir.native());
+
+  return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
+      std::unique_ptr<Module>{new ArchiveModule{mod_dir, hash}});
+}
+
+ArchiveModule::ArchiveModule(const std::filesystem::path &path,
+                             std::string hash) noexcept
+    : m_path{path}, m_hash{std::move(hash)} {}
+
+[[nodiscard]] std::string ArchiveModule::name() const noexcept {
+  return m_path.filename().string();
+}
+
+[[nodiscard]] std::filesystem::path ArchiveModule::disk_path() const noexcept {
+  return m_path;
+}
+
+[[nodiscard]] bool ArchiveModule::has_revisions() const noexcept {
+  return true;
+}
+
+[[nodiscard]] runtime::Result<std::string, std::string>
+ArchiveModule::head() const noexcept {
+  return runtime::Result<std::string, std::string>::ok(m_hash);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+ArchiveModule::fetch() const noexcept {
+  // The archive was fetched when the module was extracted
+  return runtime::Result<void, std::string>::ok();
+}
+
+[[nodiscard]] runtime::Result<bool, std::string>
+ArchiveModule::has_revision(std::string_view revision) const noexcept {
+  return runtime::Result<bool, std::string>::ok(lowercase(revision) == m_hash);
+}
+
+[[nodiscard]] runtime::Result<bool, std::string>
+ArchiveModule::is_ancestor(std::string_view ancestor,
+                           std::string_view revision) const noexcept {
+  // The version of an archive is only a label, the hash identifies it
+  static_cast<void>(revision);
+  return runtime::Result<bool, std::string>::ok(lowercase(ancestor) == m_hash);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+ArchiveModule::checkout(std::string_view revision) const noexcept {
+  if (lowercase(revision) != m_hash) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Archive module {} only has revision {}, not {}", name(),
+                    m_hash, revision));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::module
@@ -1,13 +1,19 @@
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "yabt/log/log.h"
 #include "yabt/module/git_module.h"
 #include "yabt/module/module.h"
 #include "yabt/process/process.h"
 #include "yabt/runtime/result.h"
+#include "yabt/utils/file.h"
+#include "yabt/utils/sha256.h"
 #include "yabt/utils/string.h"
 
 namespace yabt::module {
@@ -23,6 +29,150 @@ exec_git_command(Args &&...args) noexcept {
   return runtime::Result<process::Process::ProcessOutput, std::string>::ok(
       git_proc.process_output());
 }
+
+[[nodiscard]] runtime::Result<bool, std::string>
+has_commit(const std::filesystem::path &repo_dir,
+           std::string_view revision) noexcept {
+  const ProcessOutput process_output = RESULT_PROPAGATE(
+      exec_git_command("-C", repo_dir.native(), "cat-file", "-e",
+                       std::string{revision} + "^{commit}"));
+  // cat-file -e exits with 1 or 128 when the object does not exist
+  return std::visit(
+      [&process_output]<typename T>(const T v) {
+        if constexpr (std::same_as<T, process::Process::NormalExit>) {
+          return runtime::Result<bool, std::string>::ok(!v.exit_code);
+        } else if constexpr (std::same_as<T,
+                                          process::Process::UnhandledSignal>) {
+          return runtime::Result<bool, std::string>::error(
+              std::format("Exited with signal {}\nstderr: {}", v.signal,
+                          process_output.stderr.value_or("")));
+        }
+        runtime::fatal("Unhandled type");
+      },
+      process_output.exit_reason);
+}
+
+[[nodiscard]] std::optional<std::string>
+read_first_line(const std::filesystem::path &path) noexcept {
+  std::ifstream stream{path};
+  std::string line;
+  if (!std::getline(stream, line)) {
+    return std::nullopt;
+  }
+  return std::string{utils::trim_whitespace(line)};
+}
+
+[[nodiscard]] bool is_object_id(std::string_view id) noexcept {
+  // SHA-1 or SHA-256 object ids
+  return (id.size() == 40 || id.size() == 64) &&
+         std::all_of(id.cbegin(), id.cend(), [](const char c) {
+           return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+         });
+}
+
+[[nodiscard]] std::optional<std::string>
+read_packed_ref(const std::filesystem::path &git_dir,
+                std::string_view ref) noexcept {
+  std::ifstream stream{git_dir / "packed-refs"};
+  std::string line;
+  while (std::getline(stream, line)) {
+    // Lines are "<id> <ref>", besides comments and peeled tags
+    const size_t space = line.find(' ');
+    if (line.starts_with('#') || line.starts_with('^') ||
+        space == std::string::npos) {
+      continue;
+    }
+    if (utils::trim_whitespace(std::string_view{line}.substr(space + 1)) ==
+        ref) {
+      return line.substr(0, space);
+    }
+  }
+  return std::nullopt;
+}
+
+// Resolves HEAD by reading the git directory, which is much cheaper than
+// running git. Layouts other than a plain .git directory with HEAD pointing
+// to a commit or to a loose or packed branch are left to git.
+[[nodiscard]] std::optional<std::string>
+read_head(const std::filesystem::path &git_dir) noexcept {
+  if (!std::filesystem::is_directory(git_dir) ||
+      std::filesystem::exists(git_dir / "commondir")) {
+    return std::nullopt;
+  }
+
+  const std::optional<std::string> head = read_first_line(git_dir / "HEAD");
+  if (!head.has_value()) {
+    return std::nullopt;
+  }
+
+  constexpr static std::string_view SYMREF_PREFIX = "ref: ";
+  if (!head->starts_with(SYMREF_PREFIX)) {
+    return is_object_id(*head) ? head : std::nullopt;
+  }
+
+  const std::string ref = head->substr(SYMREF_PREFIX.size());
+  std::optional<std::string> id = read_first_line(git_dir / ref);
+  if (!id.has_value()) {
+    id = read_packed_ref(git_dir, ref);
+  }
+  if (!id.has_value() || !is_object_id(*id)) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+// Clones or updates the bare mirror of the url in the cache and returns its
+// path. The mirror is not updated if it already has the hash. Clones borrow
+// objects from mirrors, so mirrors are never pruned nor garbage collected.
+[[nodiscard]] runtime::Result<std::filesystem::path, std::string>
+update_mirror(const std::filesystem::path &cache_dir, std::string_view url,
+              std::string_view hash) noexcept {
+  const std::filesystem::path git_cache_dir = cache_dir / GIT_CACHE_DIR_NAME;
+  std::error_code error_code;
+  std::filesystem::create_directories(git_cache_dir, error_code);
+  if (error_code) {
+    return runtime::Result<std::filesystem::path, std::string>::error(
+        std::format("Unable to create git cache at {}: {}",
+                    git_cache_dir.native(), error_code.message()));
+  }
+
+  utils::Sha256 url_hash;
+  url_hash.update(url);
+  const std::filesystem::path mirror_dir =
+      git_cache_dir / url_hash.hex_digest();
+
+  // Other workspaces may be syncing the same url
+  const utils::FileLock _lock = RESULT_PROPAGATE(
+      utils::FileLock::acquire(mirror_dir.native() + ".lock"));
+
+  if (!std::filesystem::exists(mirror_dir)) {
+    // Cloned aside, so that an interrupted clone is not taken for a mirror
+    const std::filesystem::path partial_dir = mirror_dir.native() + ".partial";
+    std::filesystem::remove_all(partial_dir, error_code);
+
+    yabt_verbose("Cloning mirror of {} into {}", url, mirror_dir.native());
+    const ProcessOutput clone_output = RESULT_PROPAGATE(
+        exec_git_command("clone", "--mirror", url, partial_dir.native()));
+    RESULT_PROPAGATE_DISCARD(clone_output.to_result());
+    const ProcessOutput config_output = RESULT_PROPAGATE(exec_git_command(
+        "-C", partial_dir.native(), "config", "gc.auto", "0"));
+    RESULT_PROPAGATE_DISCARD(config_output.to_result());
+
+    std::filesystem::rename(partial_dir, mirror_dir, error_code);
+    if (error_code) {
+      return runtime::Result<std::filesystem::path, std::string>::error(
+          std::format("Unable to move mirror to {}: {}", mirror_dir.native(),
+                      error_code.message()));
+    }
+  } else if (hash.empty() || !RESULT_PROPAGATE(has_commit(mirror_dir, hash))) {
+    yabt_verbose("Updating mirror of {} at {}", url, mirror_dir.native());
+    const ProcessOutput fetch_output = RESULT_PROPAGATE(
+        exec_git_command("-C", mirror_dir.native(), "fetch", "origin"));
+    RESULT_PROPAGATE_DISCARD(fetch_output.to_result());
+  }
+
+  return runtime::Result<std::filesystem::path, std::string>::ok(mirror_dir);
+}
 } // namespace
 
 runtime::Result<std::unique_ptr<Module>, std::string>
@@ -37,37 +187,70 @@ GitModule::open(std::filesystem::path mod_dir) noexcept {
 }
 
 runtime::Result<std::unique_ptr<Module>, std::string>
-GitModule::open_or_fetch_module(const std::filesystem::path &mod_dir,
-                                std::string_view mod_url,
-                                std::string_view mod_type,
-                                std::string_view mod_hash) noexcept {
+GitModule::open_or_fetch_module(
+    const std::filesystem::path &mod_dir, std::string_view mod_url,
+    std::string_view mod_type, std::string_view mod_hash,
+    const std::optional<std::filesystem::path> &cache_dir) noexcept {
   if (const std::filesystem::path git_dir = mod_dir / ".git";
       std::filesystem::exists(git_dir)) {
     // Return existing module
     yabt_debug("Opening already-existing git module at {}", mod_dir.native());
-    return GitModule::open(mod_dir);
+    return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
+        std::unique_ptr<Module>{new GitModule{mod_dir, cache_dir, mod_url}});
   }
 
-  const ProcessOutput process_output =
-      RESULT_PROPAGATE(exec_git_command("clone", mod_url, mod_dir.native()));
+  static_cast<void>(mod_type);
+
+  const bool pinned = !mod_hash.empty();
+  std::optional<std::filesystem::path> mirror_dir;
+  std::vector<std::string> clone_args{"clone"};
+  if (cache_dir.has_value()) {
+    // Cloned from the mirror, borrowing its objects instead of copying them
+    mirror_dir = RESULT_PROPAGATE(update_mirror(*cache_dir, mod_url, mod_hash));
+    clone_args.push_back("--shared");
+  } else if (pinned) {
+    // Pinned modules skip the blobs of every revision other than the pinned
+    // one, which are fetched lazily when it gets checked out
+    clone_args.push_back("--filter=blob:none");
+  }
+  if (pinned) {
+    clone_args.push_back("--no-checkout");
+  }
+  clone_args.insert(clone_args.end(),
+                    {mirror_dir.has_value() ? mirror_dir->native()
+                                            : std::string{mod_url},
+                     mod_dir.native()});
+
+  const ProcessOutput process_output = RESULT_PROPAGATE(
+      exec_git_command(std::span<const std::string>{clone_args}));
   if (runtime::Result result = process_output.to_result(); result.is_error()) {
     yabt_error("Error cloning git module {}\nstderr: {}", mod_url,
                process_output.stderr.value_or(""));
     RESULT_PROPAGATE_DISCARD(result);
   }
 
-  // FIXME checkout right project version
-  static_cast<void>(mod_type);
-  static_cast<void>(mod_hash);
+  if (mirror_dir.has_value()) {
+    // Later fetches go to the original remote
+    const ProcessOutput set_url_output = RESULT_PROPAGATE(exec_git_command(
+        "-C", mod_dir.native(), "remote", "set-url", "origin", mod_url));
+    RESULT_PROPAGATE_DISCARD(set_url_output.to_result());
+  }
+
+  std::unique_ptr<GitModule> module{new GitModule{mod_dir, cache_dir, mod_url}};
+  if (pinned && RESULT_PROPAGATE(module->has_revision(mod_hash))) {
+    RESULT_PROPAGATE_DISCARD(module->checkout(mod_hash));
+  }
 
   yabt_debug("Successfully fetched git module at {}", mod_dir.native());
 
   return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
-      std::unique_ptr<Module>{new GitModule{mod_dir}});
+      std::move(module));
 }
 
-GitModule::GitModule(const std::filesystem::path &path) noexcept
-    : m_path{path} {}
+GitModule::GitModule(const std::filesystem::path &path,
+                     std::optional<std::filesystem::path> cache_dir,
+                     std::string_view url) noexcept
+    : m_path{path}, m_cache_dir{std::move(cache_dir)}, m_url{url} {}
 
 [[nodiscard]] std::string GitModule::name() const noexcept {
   return m_path.filename().string();
@@ -77,8 +260,15 @@ GitModule::GitModule(const std::filesystem::path &path) noexcept
   return m_path;
 }
 
+[[nodiscard]] bool GitModule::has_revisions() const noexcept { return true; }
+
 [[nodiscard]] runtime::Result<std::string, std::string>
 GitModule::head() const noexcept {
+  if (std::optional<std::string> head = read_head(m_path / ".git");
+      head.has_value()) {
+    return runtime::Result<std::string, std::string>::ok(std::move(*head));
+  }
+
   const ProcessOutput process_output = RESULT_PROPAGATE(exec_git_command(
       "-C", m_path.native(), "rev-list", "--max-count=1", "HEAD"));
   RESULT_PROPAGATE_DISCARD(process_output.to_result());
@@ -88,12 +278,31 @@ GitModule::head() const noexcept {
 
 [[nodiscard]] runtime::Result<void, std::string>
 GitModule::fetch() const noexcept {
+  // Clones that borrow objects from a mirror fetch from the updated mirror, so
+  // that the remote is only contacted once. The refs are the ones a fetch from
+  // origin would have updated.
+  if (m_cache_dir.has_value() &&
+      std::filesystem::exists(m_path / ".git/objects/info/alternates")) {
+    const std::filesystem::path mirror_dir =
+        RESULT_PROPAGATE(update_mirror(*m_cache_dir, m_url, ""));
+    const ProcessOutput process_output = RESULT_PROPAGATE(exec_git_command(
+        "-C", m_path.native(), "fetch", "--tags", mirror_dir.native(),
+        "+refs/heads/*:refs/remotes/origin/*"));
+    RESULT_PROPAGATE_DISCARD(process_output.to_result());
+    return runtime::Result<void, std::string>::ok();
+  }
+
   const ProcessOutput process_output = RESULT_PROPAGATE(
       exec_git_command("-C", m_path.native(), "fetch", "--all", "--tags"));
   RESULT_PROPAGATE_DISCARD(process_output.to_result());
   return runtime::Result<void, std::string>::ok();
 }
 
+[[nodiscard]] runtime::Result<bool, std::string>
+GitModule::has_revision(std::string_view revision) const noexcept {
+  return has_commit(m_path, revision);
+}
+
 [[nodiscard]] runtime::Result<bool, std::string>
 GitModule::is_ancestor(std::string_view ancestor,
                        std::string_view revision) const noexcept {
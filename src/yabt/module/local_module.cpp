@@ -0,0 +1,117 @@
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "yabt/log/log.h"
+#include "yabt/module/local_module.h"
+#include "yabt/runtime/result.h"
+
+namespace yabt::module {
+
+runtime::Result<std::unique_ptr<Module>, std::string>
+LocalModule::open(std::filesystem::path mod_dir) noexcept {
+  if (!std::filesystem::is_symlink(mod_dir)) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error("");
+  }
+
+  return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
+      std::unique_ptr<Module>{new LocalModule{mod_dir}});
+}
+
+runtime::Result<std::unique_ptr<Module>, std::string>
+LocalModule::open_or_fetch_module(const std::filesystem::path &mod_dir,
+                                  std::string_view mod_url) noexcept {
+  constexpr static std::string_view FILE_SCHEME = "file://";
+  if (mod_url.starts_with(FILE_SCHEME)) {
+    mod_url.remove_prefix(FILE_SCHEME.size());
+  }
+  const std::filesystem::path target =
+      (mod_dir.parent_path().parent_path() / mod_url).lexically_normal();
+
+  std::error_code error_code;
+  if (!std::filesystem::is_directory(target, error_code)) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("Local module {} is not a directory", target.native()));
+  }
+
+  if (std::filesystem::is_symlink(mod_dir, error_code)) {
+    if (std::filesystem::read_symlink(mod_dir, error_code) == target) {
+      yabt_debug("Opening already-linked local module at {}",
+                 mod_dir.native());
+      return LocalModule::open(mod_dir);
+    }
+    std::filesystem::remove(mod_dir, error_code);
+  } else if (std::filesystem::exists(mod_dir, error_code)) {
+    // Never delete what could be a checkout with local changes
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("{} already exists. Remove it to use the local module at "
+                    "{} instead",
+                    mod_dir.native(), target.native()));
+  }
+
+  std::filesystem::create_directories(mod_dir.parent_path(), error_code);
+  if (!error_code) {
+    std::filesystem::create_directory_symlink(target, mod_dir, error_code);
+  }
+  if (error_code) {
+    return runtime::Result<std::unique_ptr<Module>, std::string>::error(
+        std::format("Unable to link {} to {}: {}", mod_dir.native(),
+                    target.native(), error_code.message()));
+  }
+
+  yabt_debug("Linked local module at {} to {}", mod_dir.native(),
+             target.native());
+
+  return runtime::Result<std::unique_ptr<Module>, std::string>::ok(
+      std::unique_ptr<Module>{new LocalModule{mod_dir}});
+}
+
+LocalModule::LocalModule(const std::filesystem::path &path) noexcept
+    : m_path{path} {}
+
+[[nodiscard]] std::string LocalModule::name() const noexcept {
+  return m_path.filename().string();
+}
+
+[[nodiscard]] std::filesystem::path LocalModule::disk_path() const noexcept {
+  return m_path;
+}
+
+[[nodiscard]] bool LocalModule::has_revisions() const noexcept {
+  return false;
+}
+
+[[nodiscard]] runtime::Result<std::string, std::string>
+LocalModule::head() const noexcept {
+  return runtime::Result<std::string, std::string>::error(
+      std::format("Local module {} has no revisions", name()));
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+LocalModule::fetch() const noexcept {
+  return runtime::Result<void, std::string>::ok();
+}
+
+[[nodiscard]] runtime::Result<bool, std::string>
+LocalModule::has_revision(std::string_view revision) const noexcept {
+  static_cast<void>(revision);
+  return runtime::Result<bool, std::string>::ok(false);
+}
+
+[[nodiscard]] runtime::Result<bool, std::string>
+LocalModule::is_ancestor(std::string_view ancestor,
+                         std::string_view revision) const noexcept {
+  static_cast<void>(ancestor);
+  static_cast<void>(revision);
+  return runtime::Result<bool, std::string>::ok(false);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+LocalModule::checkout(std::string_view revision) const noexcept {
+  return runtime::Result<void, std::string>::error(
+      std::format("Local module {} has no revisions to check out {}", name(),
+                  revision));
+}
+
+} // namespace yabt::module
@@ -0,0 +1,112 @@
+#include <fstream>
+
+#include "yabt/lua/utils.h"
+#include "yabt/module/lock_file.h"
+#include "yabt/utils/defer.h"
+
+namespace yabt::lua {
+
+LUA_STRUCT_PARSE_SPEC_DEF(        //
+    ::yabt::module::LockedModule, //
+    (std::string, url),           //
+    (std::string, hash),          //
+    (std::string, type)           //
+);
+
+LUA_STRUCT_PARSE_SPEC_DEF(                     //
+    ::yabt::module::LockFile,                  //
+    (int, version),                            //
+    (std::string, module_file_hash),           //
+    (::yabt::module::LockedModuleMap, modules) //
+);
+
+} // namespace yabt::lua
+
+namespace yabt::module {
+
+namespace {
+
+[[nodiscard]] std::string lua_quote(const std::string_view unquoted) noexcept {
+  std::string quoted{"\""};
+  for (const char c : unquoted) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+      quoted += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      // Padded, so that a digit following the escape is not part of it
+      quoted += std::format("\\{:03}", static_cast<unsigned>(c));
+    } else {
+      quoted += c;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+} // namespace
+
+[[nodiscard]] runtime::Result<LockFile, std::string>
+LockFile::load_lock_file(const std::filesystem::path path) noexcept {
+  lua_State *const L = luaL_newstate();
+  if (L == nullptr) {
+    return runtime::Result<LockFile, std::string>::error(
+        "Unable to create lua state");
+  }
+  utils::Defer _deleteL{[L]() { lua_close(L); }};
+
+  const int err = luaL_dofile(L, path.c_str());
+  if (err != 0 /* LUA_OK */) {
+    const std::string error_msg =
+        RESULT_PROPAGATE(lua::parse_lua_object<std::string>(L));
+    return runtime::Result<LockFile, std::string>::error(
+        std::format("Error loading lock file: {}", error_msg));
+  }
+
+  const LockFile lock = RESULT_PROPAGATE(lua::parse_lua_object<LockFile>(L));
+  if (lock.version != LOCK_FILE_VERSION) {
+    return runtime::Result<LockFile, std::string>::error(
+        std::format("Unsupported lock file version: {}", lock.version));
+  }
+  return runtime::Result<LockFile, std::string>::ok(lock);
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+LockFile::write_lock_file(const std::filesystem::path &path) const noexcept {
+  // Written aside and renamed, so that an interrupted sync does not leave a
+  // truncated lock file behind
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+
+  std::ofstream stream{tmp_path};
+  stream << "-- Generated by yabt sync. Do not edit.\n"
+         << "return {\n"
+         << "  version = " << version << ",\n"
+         << "  module_file_hash = " << lua_quote(module_file_hash) << ",\n"
+         << "  modules = {\n";
+  for (const auto &[name, module] : modules) {
+    stream << "    [" << lua_quote(name) << "] = {\n"
+           << "      url = " << lua_quote(module.url) << ",\n"
+           << "      hash = " << lua_quote(module.hash) << ",\n"
+           << "      type = " << lua_quote(module.type) << ",\n"
+           << "    },\n";
+  }
+  stream << "  },\n"
+         << "}\n";
+  stream.close();
+
+  std::error_code error_code;
+  if (!stream) {
+    std::filesystem::remove(tmp_path, error_code);
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to write {}", tmp_path.native()));
+  }
+
+  std::filesystem::rename(tmp_path, path, error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Unable to save {}: {}", path.native(), error_code.message()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::module
@@ -1,9 +1,29 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
 #include "yabt/module/module.h"
+#include "yabt/module/archive_module.h"
 #include "yabt/module/git_module.h"
+#include "yabt/module/local_module.h"
 #include "yabt/runtime/result.h"
 
 namespace yabt::module {
 
+namespace {
+
+// Module types are matched case-insensitively, e.g. 'Git' or 'git'
+[[nodiscard]] bool is_type(std::string_view mod_type,
+                           std::string_view type) noexcept {
+  return std::ranges::equal(mod_type, type, [](const char a, const char b) {
+    return std::tolower(static_cast<unsigned char>(a)) == b;
+  });
+}
+
+} // namespace
+
 std::optional<std::filesystem::path> Module::rules_dir() const noexcept {
   std::filesystem::path rules_dir = disk_path() / "rules";
   if (std::filesystem::exists(rules_dir)) {
@@ -14,11 +34,20 @@ std::optional<std::filesystem::path> Module::rules_dir() const noexcept {
 
 [[nodiscard]] runtime::Result<std::unique_ptr<Module>, std::string>
 open_module(const std::filesystem::path &mod_dir) {
+  // Checked first, as the linked directory may well be a git repository
+  if (std::filesystem::is_symlink(mod_dir)) {
+    return LocalModule::open(mod_dir);
+  }
+
   if (const std::filesystem::path git_dir = mod_dir / ".git";
       std::filesystem::exists(git_dir)) {
     return GitModule::open(mod_dir);
   }
 
+  if (std::filesystem::exists(mod_dir / ARCHIVE_MARKER_FILE_NAME)) {
+    return ArchiveModule::open(mod_dir);
+  }
+
   return runtime::Result<std::unique_ptr<Module>, std::string>::error(
       std::format("Could not detect module type for: {}", mod_dir.native()));
 }
@@ -26,20 +55,54 @@ open_module(const std::filesystem::path &mod_dir) {
 [[nodiscard]] runtime::Result<std::unique_ptr<Module>, std::string>
 open_or_fetch_module(const std::filesystem::path &mod_dir,
                      std::string_view mod_url, std::string_view mod_type,
-                     std::string_view mod_hash) {
+                     std::string_view mod_hash,
+                     const std::optional<std::filesystem::path> &cache_dir) {
 
-  if (mod_type == "git") {
+  if (is_type(mod_type, "local")) {
+    return LocalModule::open_or_fetch_module(mod_dir, mod_url);
+  }
+
+  if (is_type(mod_type, "archive")) {
+    return ArchiveModule::open_or_fetch_module(mod_dir, mod_url, mod_hash,
+                                               cache_dir);
+  }
+
+  if (is_type(mod_type, "git")) {
     return GitModule::open_or_fetch_module(mod_dir, mod_url, mod_type,
-                                           mod_hash);
+                                           mod_hash, cache_dir);
   }
 
   if (mod_url.ends_with(".git")) {
     return GitModule::open_or_fetch_module(mod_dir, mod_url, mod_type,
-                                           mod_hash);
+                                           mod_hash, cache_dir);
   }
 
   return runtime::Result<std::unique_ptr<Module>, std::string>::error(
       std::format("Could not detect module type for: {}", mod_url));
 }
 
+[[nodiscard]] std::string resolve_url(const std::filesystem::path &mod_dir,
+                                      std::string_view mod_url,
+                                      std::string_view mod_type) noexcept {
+  constexpr static std::string_view FILE_SCHEME = "file://";
+  std::string_view path = mod_url;
+  if (path.starts_with(FILE_SCHEME)) {
+    path.remove_prefix(FILE_SCHEME.size());
+  }
+  if (!is_type(mod_type, "local") ||
+      std::filesystem::path{path}.is_absolute()) {
+    return std::string{mod_url};
+  }
+
+  // A local module is a symlink, so its own local dependencies are found
+  // from the directory it links to
+  std::error_code error_code;
+  std::filesystem::path base_dir =
+      std::filesystem::canonical(mod_dir, error_code);
+  if (error_code) {
+    base_dir = std::filesystem::absolute(mod_dir, error_code);
+  }
+  return (base_dir / path).lexically_normal().native();
+}
+
 } // namespace yabt::module
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/log/log.h"
+#include "yabt/ninja/compdb.h"
+#include "yabt/utils/hash.h"
+#include "yabt/utils/string.h"
+
+namespace yabt::ninja {
+
+namespace {
+
+// Guards against rule variables that (directly or indirectly) refer to
+// themselves.
+constexpr static size_t MAX_EXPANSION_DEPTH = 16;
+
+[[nodiscard]] bool is_simple_varname_char(const char c) noexcept {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+[[nodiscard]] bool is_shell_safe_char(const char c) noexcept {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '+' || c == '-' ||
+         c == '.' || c == '/';
+}
+
+// Same quoting ninja applies to paths in $in and $out
+void append_shell_escaped(std::string &result, const std::string_view path) {
+  bool safe = true;
+  for (const char c : path) {
+    if (!is_shell_safe_char(c)) {
+      safe = false;
+      break;
+    }
+  }
+
+  if (safe) {
+    result.append(path);
+    return;
+  }
+
+  result.push_back('\'');
+  for (const char c : path) {
+    if (c == '\'') {
+      result.append("'\\''");
+    } else {
+      result.push_back(c);
+    }
+  }
+  result.push_back('\'');
+}
+
+template <typename PathType>
+[[nodiscard]] std::string join_paths(const std::vector<PathType> &paths) {
+  std::string result;
+  for (const PathType &path : paths) {
+    if (!result.empty()) {
+      result.push_back(' ');
+    }
+    append_shell_escaped(result, path.path);
+  }
+  return result;
+}
+
+template <typename Lookup>
+[[nodiscard]] std::string expand_string(const std::string_view str,
+                                        const Lookup &lookup) {
+  std::string result;
+  result.reserve(str.size());
+
+  size_t i = 0;
+  while (i < str.size()) {
+    const char c = str[i++];
+    if (c != '$' || i == str.size()) {
+      result.push_back(c);
+      continue;
+    }
+
+    const char next = str[i];
+    if (next == '$' || next == ' ' || next == ':') {
+      result.push_back(next);
+      i++;
+    } else if (next == '\n') {
+      // Line continuation, skip leading whitespace on the next line
+      i++;
+      while (i < str.size() && str[i] == ' ') {
+        i++;
+      }
+    } else if (next == '{') {
+      const size_t end = str.find('}', i);
+      if (end == std::string_view::npos) {
+        result.append(str.substr(i - 1));
+        break;
+      }
+      result.append(lookup(str.substr(i + 1, end - i - 1)));
+      i = end + 1;
+    } else {
+      const size_t start = i;
+      while (i < str.size() && is_simple_varname_char(str[i])) {
+        i++;
+      }
+      result.append(lookup(str.substr(start, i - start)));
+    }
+  }
+  return result;
+}
+
+[[nodiscard]] std::string
+lookup_variable(const BuildRule &rule, const BuildStepWithRule &step,
+                const std::string_view name, const size_t depth) {
+  if (depth > MAX_EXPANSION_DEPTH) {
+    return "";
+  }
+
+  if (name == "in") {
+    return join_paths(step.ins);
+  }
+
+  if (name == "out") {
+    return join_paths(step.outs);
+  }
+
+  // Build step variables are evaluated in the file scope, where no other
+  // variables are defined. Empty ones are not emitted to the ninja file.
+  if (const auto it = step.variables.find(std::string{name});
+      it != step.variables.cend() && !it->second.empty()) {
+    return expand_string(it->second,
+                         [](std::string_view) { return std::string{}; });
+  }
+
+  // Rule variables are evaluated in the scope of the build step
+  if (const auto it = rule.variables.find(std::string{name});
+      it != rule.variables.cend()) {
+    return expand_string(it->second, [&](const std::string_view inner) {
+      return lookup_variable(rule, step, inner, depth + 1);
+    });
+  }
+
+  return "";
+}
+
+constexpr static std::string_view FRAGMENT_NAME = "compile_commands.json";
+constexpr static std::string_view INDEX_SUFFIX = ".index";
+// The fragments keep their own index, since the database is also written
+// without them
+constexpr static std::string_view FRAGMENTS_INDEX_NAME = "fragments.index";
+constexpr static std::string_view INDEX_HEADER = "# yabt compdb index v1";
+
+// One record per entry of the compilation database
+struct IndexEntry final {
+  uint64_t hash;
+  std::string file;
+
+  [[nodiscard]] bool operator==(const IndexEntry &) const = default;
+};
+
+[[nodiscard]] const BuildRule *
+find_compdb_rule(const std::map<std::string, BuildRule> &build_rules,
+                 const BuildStepWithRule &step) noexcept {
+  const auto rule = build_rules.find(step.rule_name);
+  if (rule == build_rules.cend() || !rule->second.compdb ||
+      step.ins.empty() || step.outs.empty()) {
+    return nullptr;
+  }
+  return &rule->second;
+}
+
+[[nodiscard]] std::string format_entry(const std::string &directory,
+                                       const BuildRule &rule,
+                                       const BuildStepWithRule &step) {
+  return std::format("  {{\n"
+                     "    \"directory\": \"{}\",\n"
+                     "    \"command\": \"{}\",\n"
+                     "    \"file\": \"{}\",\n"
+                     "    \"output\": \"{}\"\n"
+                     "  }}",
+                     directory,
+                     utils::json_escape(expand_command(rule, step)),
+                     utils::json_escape(step.ins.front().path),
+                     utils::json_escape(step.outs.front().path));
+}
+
+[[nodiscard]] std::vector<IndexEntry>
+load_index(const std::filesystem::path &index_path) noexcept {
+  std::vector<IndexEntry> index;
+  std::ifstream stream{index_path};
+  std::string line;
+  if (!std::getline(stream, line) || line != INDEX_HEADER) {
+    return index;
+  }
+
+  while (std::getline(stream, line)) {
+    const size_t separator = line.find(' ');
+    if (separator == std::string::npos) {
+      return std::vector<IndexEntry>{};
+    }
+    index.push_back(IndexEntry{
+        .hash = std::strtoull(line.c_str(), nullptr, 16),
+        .file{line.substr(separator + 1)},
+    });
+  }
+  return index;
+}
+
+// Writes the file at `path` atomically, by writing a temporary file first
+template <typename Writer>
+[[nodiscard]] runtime::Result<void, std::string>
+write_file_atomically(const std::filesystem::path &path, const Writer &writer) {
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+
+  std::error_code error_code;
+  std::filesystem::create_directories(path.parent_path(), error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Failed to create directory {}: {}",
+                    path.parent_path().native(), error_code.message()));
+  }
+
+  FILE *file = fopen(tmp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Error opening {}: {}", tmp_path.native(), strerror(errno)));
+  }
+
+  writer(file);
+
+  const bool write_failed = ferror(file) != 0;
+  fclose(file);
+
+  if (write_failed) {
+    std::filesystem::remove(tmp_path, error_code);
+    return runtime::Result<void, std::string>::error(
+        std::format("Error writing {}", tmp_path.native()));
+  }
+
+  std::filesystem::rename(tmp_path, path, error_code);
+  if (error_code) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "Error saving {}: {}", path.native(), error_code.message()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+save_index(const std::filesystem::path &index_path,
+           const std::span<const IndexEntry> index) noexcept {
+  return write_file_atomically(index_path, [index](FILE *file) {
+    fprintf(file, "%s\n", INDEX_HEADER.data());
+    for (const IndexEntry &entry : index) {
+      fprintf(file, "%s\n",
+              std::format("{:016x} {}", entry.hash, entry.file).c_str());
+    }
+  });
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+write_compdb(const std::filesystem::path &path, const std::string &directory,
+             const std::map<std::string, BuildRule> &build_rules,
+             const std::span<const BuildStepWithRule> build_steps_with_rule,
+             const std::span<const size_t> step_indices) noexcept {
+  return write_file_atomically(path, [&](FILE *file) {
+    fprintf(file, "[");
+    bool first = true;
+    for (const size_t i : step_indices) {
+      const BuildStepWithRule &step = build_steps_with_rule[i];
+      const BuildRule &rule = build_rules.at(step.rule_name);
+      fprintf(file, "%s\n%s", first ? "" : ",",
+              format_entry(directory, rule, step).c_str());
+      first = false;
+    }
+    fprintf(file, "\n]\n");
+  });
+}
+
+[[nodiscard]] std::filesystem::path
+fragment_path(const CompdbFragments &fragments,
+              const std::filesystem::path &source_dir) noexcept {
+  const std::filesystem::path relative =
+      source_dir.lexically_relative(fragments.source_root);
+  if (relative.empty() || *relative.begin() == "..") {
+    return fragments.output_dir / "external" / source_dir.relative_path() /
+           FRAGMENT_NAME;
+  }
+  return fragments.output_dir / relative / FRAGMENT_NAME;
+}
+
+// Groups entries (given by their position in the index) by the directory of
+// their source file.
+[[nodiscard]] std::map<std::filesystem::path, std::vector<size_t>>
+group_by_directory(const std::span<const IndexEntry> index) noexcept {
+  std::map<std::filesystem::path, std::vector<size_t>> groups;
+  for (size_t i = 0; i < index.size(); i++) {
+    groups[std::filesystem::path{index[i].file}.parent_path()].push_back(i);
+  }
+  return groups;
+}
+
+[[nodiscard]] bool
+same_entries(const std::span<const IndexEntry> lhs,
+             const std::span<const size_t> lhs_positions,
+             const std::span<const IndexEntry> rhs,
+             const std::span<const size_t> rhs_positions) noexcept {
+  if (lhs_positions.size() != rhs_positions.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs_positions.size(); i++) {
+    if (lhs[lhs_positions[i]] != rhs[rhs_positions[i]]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[nodiscard]] runtime::Result<void, std::string>
+write_fragments(const CompdbFragments &fragments, const std::string &directory,
+                const std::map<std::string, BuildRule> &build_rules,
+                const std::span<const BuildStepWithRule> build_steps_with_rule,
+                const std::span<const size_t> step_indices,
+                const std::span<const IndexEntry> index) noexcept {
+  const std::filesystem::path index_path =
+      fragments.output_dir / FRAGMENTS_INDEX_NAME;
+  const std::vector<IndexEntry> old_index = load_index(index_path);
+
+  const auto groups = group_by_directory(index);
+  const auto old_groups = group_by_directory(old_index);
+
+  for (const auto &[source_dir, positions] : groups) {
+    const std::filesystem::path path = fragment_path(fragments, source_dir);
+
+    std::error_code error_code;
+    if (const auto old = old_groups.find(source_dir);
+        old != old_groups.cend() &&
+        same_entries(index, positions, old_index, old->second) &&
+        std::filesystem::exists(path, error_code)) {
+      continue;
+    }
+
+    std::vector<size_t> fragment_steps;
+    fragment_steps.reserve(positions.size());
+    for (const size_t position : positions) {
+      fragment_steps.push_back(step_indices[position]);
+    }
+
+    yabt_verbose("Writing compilation database fragment {}", path.native());
+    RESULT_PROPAGATE_DISCARD(write_compdb(path, directory, build_rules,
+                                          build_steps_with_rule,
+                                          fragment_steps));
+  }
+
+  // Remove the fragments of directories without entries
+  for (const auto &[source_dir, _] : old_groups) {
+    if (groups.contains(source_dir)) {
+      continue;
+    }
+    std::error_code error_code;
+    std::filesystem::remove(fragment_path(fragments, source_dir), error_code);
+  }
+
+  if (!std::ranges::equal(index, old_index)) {
+    std::error_code error_code;
+    std::filesystem::create_directories(fragments.output_dir, error_code);
+    RESULT_PROPAGATE_DISCARD(save_index(index_path, index));
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
+[[nodiscard]] std::string expand_command(const BuildRule &rule,
+                                         const BuildStepWithRule &step) {
+  return expand_string(rule.cmd, [&](const std::string_view name) {
+    return lookup_variable(rule, step, name, 0);
+  });
+}
+
+runtime::Result<void, std::string> save_compdb_file(
+    const std::filesystem::path &compdb_path,
+    const std::filesystem::path &build_dir,
+    const std::map<std::string, BuildRule> &build_rules,
+    const std::span<const BuildStepWithRule> build_steps_with_rule,
+    const std::optional<CompdbFragments> &fragments) noexcept {
+  const std::string directory = utils::json_escape(build_dir.native());
+
+  // First pass: hash all entries without keeping them around
+  std::vector<IndexEntry> index;
+  std::vector<size_t> step_indices;
+  for (size_t i = 0; i < build_steps_with_rule.size(); i++) {
+    const BuildStepWithRule &step = build_steps_with_rule[i];
+    const BuildRule *rule = find_compdb_rule(build_rules, step);
+    if (rule == nullptr) {
+      continue;
+    }
+    index.push_back(IndexEntry{
+        .hash = utils::fnv1a_64(format_entry(directory, *rule, step)),
+        .file{step.ins.front().path},
+    });
+    step_indices.push_back(i);
+  }
+
+  std::filesystem::path index_path = compdb_path;
+  index_path += INDEX_SUFFIX;
+  const std::vector<IndexEntry> old_index = load_index(index_path);
+
+  std::error_code error_code;
+  if (index != old_index ||
+      !std::filesystem::exists(compdb_path, error_code)) {
+    yabt_verbose("Writing compilation database {}", compdb_path.native());
+    RESULT_PROPAGATE_DISCARD(write_compdb(compdb_path, directory, build_rules,
+                                          build_steps_with_rule,
+                                          step_indices));
+  } else {
+    yabt_verbose("Compilation database {} is up to date",
+                 compdb_path.native());
+  }
+
+  if (fragments.has_value()) {
+    RESULT_PROPAGATE_DISCARD(write_fragments(
+        fragments.value(), directory, build_rules, build_steps_with_rule,
+        step_indices, index));
+  }
+
+  if (index != old_index) {
+    RESULT_PROPAGATE_DISCARD(save_index(index_path, index));
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::ninja
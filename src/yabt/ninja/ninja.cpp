@@ -1,15 +1,166 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+#include "yabt/log/log.h"
 #include "yabt/ninja/ninja.h"
 
 namespace yabt::ninja {
 
+namespace {
+
+// Build statement, either a `BuildStep` or a `BuildStepWithRule`
+struct Statement final {
+  const std::vector<lua::OutPath> &outs;
+  const std::vector<lua::Path> &ins;
+  bool phony;
+};
+
+// Returns the order in which build statements are written. Indices below
+// `build_steps.size()` refer to `build_steps`, the rest to
+// `build_steps_with_rule`.
+[[nodiscard]] std::vector<size_t> schedule_statements(
+    const std::span<const BuildStep> build_steps,
+    const std::span<const BuildStepWithRule> build_steps_with_rule,
+    const StepDurations &step_durations) noexcept {
+  std::vector<Statement> statements;
+  statements.reserve(build_steps.size() + build_steps_with_rule.size());
+  for (const BuildStep &step : build_steps) {
+    statements.push_back(Statement{step.outs, step.ins, false});
+  }
+  for (const BuildStepWithRule &step : build_steps_with_rule) {
+    statements.push_back(
+        Statement{step.outs, step.ins, step.rule_name == "phony"});
+  }
+
+  std::vector<size_t> order(statements.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  if (step_durations.empty()) {
+    return order;
+  }
+
+  // Steps that never ran are assumed to take the average time
+  uint64_t total_ms = 0;
+  for (const auto &[_, duration_ms] : step_durations) {
+    total_ms += duration_ms;
+  }
+  const uint64_t average_ms = total_ms / step_durations.size();
+
+  std::vector<uint64_t> weights(statements.size());
+  std::map<std::string_view, size_t> producers;
+  for (size_t i = 0; i < statements.size(); i++) {
+    for (const lua::OutPath &out : statements[i].outs) {
+      producers.insert(std::pair{std::string_view{out.path}, i});
+    }
+    if (statements[i].phony) {
+      continue;
+    }
+    const auto duration =
+        step_durations.find(statements[i].outs.front().path);
+    weights[i] =
+        duration != step_durations.cend() ? duration->second : average_ms;
+  }
+
+  std::vector<std::vector<size_t>> consumers(statements.size());
+  std::vector<size_t> pending_deps(statements.size());
+  for (size_t i = 0; i < statements.size(); i++) {
+    for (const lua::Path &in : statements[i].ins) {
+      if (const auto producer = producers.find(in.path);
+          producer != producers.cend()) {
+        consumers[producer->second].push_back(i);
+        pending_deps[i]++;
+      }
+    }
+  }
+
+  // Topological order, dependencies first
+  std::vector<size_t> topological;
+  topological.reserve(statements.size());
+  std::deque<size_t> ready;
+  for (size_t i = 0; i < statements.size(); i++) {
+    if (pending_deps[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  while (!ready.empty()) {
+    const size_t i = ready.front();
+    ready.pop_front();
+    topological.push_back(i);
+    for (const size_t consumer : consumers[i]) {
+      if (--pending_deps[consumer] == 0) {
+        ready.push_back(consumer);
+      }
+    }
+  }
+  if (topological.size() != statements.size()) {
+    // Ninja will report the cycle, keep the original order
+    yabt_debug("Build graph contains a cycle, not scheduling statements");
+    return order;
+  }
+
+  // Length of the longest chain of steps starting at each statement
+  std::vector<uint64_t> critical_path_ms(statements.size());
+  for (auto it = topological.crbegin(); it != topological.crend(); it++) {
+    uint64_t longest_consumer_ms = 0;
+    for (const size_t consumer : consumers[*it]) {
+      longest_consumer_ms =
+          std::max(longest_consumer_ms, critical_path_ms[consumer]);
+    }
+    critical_path_ms[*it] = weights[*it] + longest_consumer_ms;
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return critical_path_ms[lhs] > critical_path_ms[rhs];
+  });
+  return order;
+}
+
+void write_build_statement(FILE *file, const BuildStep &step,
+                           const size_t index) {
+  fprintf(file, "build ");
+  for (const auto &out : step.outs) {
+    fprintf(file, "%s ", out.path.c_str());
+  }
+
+  fprintf(file, ": step%ld ", index);
+  for (const auto &in : step.ins) {
+    fprintf(file, "%s ", in.path.c_str());
+  }
+  fprintf(file, "\n");
+}
+
+void write_build_statement(FILE *file, const BuildStepWithRule &step) {
+  fprintf(file, "build ");
+  for (const auto &out : step.outs) {
+    fprintf(file, "%s ", out.path.c_str());
+  }
+
+  fprintf(file, ": %s ", step.rule_name.c_str());
+  for (const auto &in : step.ins) {
+    fprintf(file, "%s ", in.path.c_str());
+  }
+  fprintf(file, "\n");
+  for (const auto &v : step.variables) {
+    if (v.first.length() == 0 || v.second.length() == 0)
+      continue;
+    fprintf(file, "    %s = %s\n", v.first.c_str(), v.second.c_str());
+  }
+}
+
+} // namespace
+
 runtime::Result<void, std::string> save_ninja_file(
     const std::filesystem::path ninja_filepath,
     const std::map<std::string, BuildRule> &build_rules,
     const std::span<const BuildStep> build_steps,
-    const std::span<const BuildStepWithRule> build_steps_with_rule) noexcept {
+    const std::span<const BuildStepWithRule> build_steps_with_rule,
+    const StepDurations &step_durations) noexcept {
 
   // FIXME: This code deserves a bit of cleanup. But for now it does the job.
   std::error_code error_code;
@@ -28,47 +179,31 @@ runtime::Result<void, std::string> save_ninja_file(
     fprintf(file, "rule step%ld\n", i++);
     fprintf(file, "    command = %s\n", step.cmd.c_str());
     fprintf(file, "    description = %s\n", step.descr.c_str());
+    if (step.restat) {
+      fprintf(file, "    restat = 1\n");
+    }
   }
 
   for (const auto &[name, rule] : build_rules) {
     fprintf(file, "rule %s\n", rule.name.c_str());
     fprintf(file, "    command = %s\n", rule.cmd.c_str());
     fprintf(file, "    description = %s\n", rule.descr.c_str());
+    if (rule.restat) {
+      fprintf(file, "    restat = 1\n");
+    }
     for (const auto &v : rule.variables) {
       fprintf(file, "    %s = %s\n", v.first.c_str(), v.second.c_str());
     }
   }
 
   // Build vals
-  i = 0;
-  for (const ninja::BuildStep &step : build_steps) {
-    fprintf(file, "build ");
-    for (const auto &out : step.outs) {
-      fprintf(file, "%s ", out.path.c_str());
-    }
-
-    fprintf(file, ": step%ld", i++);
-    for (const auto &in : step.ins) {
-      fprintf(file, "%s ", in.path.c_str());
-    }
-    fprintf(file, "\n");
-  }
-
-  for (const ninja::BuildStepWithRule &step : build_steps_with_rule) {
-    fprintf(file, "build ");
-    for (const auto &out : step.outs) {
-      fprintf(file, "%s ", out.path.c_str());
-    }
-
-    fprintf(file, ": %s ", step.rule_name.c_str());
-    for (const auto &in : step.ins) {
-      fprintf(file, "%s ", in.path.c_str());
-    }
-    fprintf(file, "\n");
-    for (const auto &v : step.variables) {
-      if (v.first.length() == 0 || v.second.length() == 0)
-        continue;
-      fprintf(file, "    %s = %s\n", v.first.c_str(), v.second.c_str());
+  for (const size_t index : schedule_statements(
+           build_steps, build_steps_with_rule, step_durations)) {
+    if (index < build_steps.size()) {
+      write_build_statement(file, build_steps[index], index);
+    } else {
+      write_build_statement(file,
+                            build_steps_with_rule[index - build_steps.size()]);
     }
   }
   fflush(file);
@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "yabt/ninja/ninja_log.h"
+
+namespace yabt::ninja {
+
+namespace {
+
+constexpr static std::string_view LOG_HEADER_PREFIX = "# ninja log v";
+constexpr static int MIN_LOG_VERSION = 5;
+
+// Splits a line into its tab separated fields
+[[nodiscard]] std::vector<std::string_view>
+split_fields(const std::string_view line) noexcept {
+  std::vector<std::string_view> fields;
+  size_t start = 0;
+  while (true) {
+    const size_t end = line.find('\t', start);
+    if (end == std::string_view::npos) {
+      fields.push_back(line.substr(start));
+      return fields;
+    }
+    fields.push_back(line.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+// Calls `handler` with every entry of the log, in file order
+template <typename Handler>
+[[nodiscard]] runtime::Result<void, std::string>
+parse_ninja_log(const std::filesystem::path &log_path,
+                const Handler &handler) noexcept {
+  std::ifstream stream{log_path};
+  if (!stream.is_open()) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to open ninja log {}", log_path.native()));
+  }
+
+  std::string line;
+  if (!std::getline(stream, line) || !line.starts_with(LOG_HEADER_PREFIX) ||
+      std::atoi(line.c_str() + LOG_HEADER_PREFIX.size()) < MIN_LOG_VERSION) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unsupported ninja log format in {}", log_path.native()));
+  }
+
+  while (std::getline(stream, line)) {
+    // start, end, mtime, output, command hash
+    const std::vector<std::string_view> fields = split_fields(line);
+    if (fields.size() != 5) {
+      continue;
+    }
+
+    handler(NinjaLogEntry{
+        .start_ms = std::strtoull(std::string{fields[0]}.c_str(), nullptr, 10),
+        .end_ms = std::strtoull(std::string{fields[1]}.c_str(), nullptr, 10),
+        .output = std::string{fields[3]},
+    });
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
+runtime::Result<std::vector<NinjaLogEntry>, std::string>
+load_ninja_log(const std::filesystem::path &log_path) noexcept {
+  using Result = runtime::Result<std::vector<NinjaLogEntry>, std::string>;
+
+  std::vector<NinjaLogEntry> entries;
+  uint64_t last_end_ms = 0;
+  RESULT_PROPAGATE_DISCARD(
+      parse_ninja_log(log_path, [&](const NinjaLogEntry &entry) {
+        // Ninja appends the steps in the order they finish, so a step ending
+        // earlier than the previous one belongs to a new run.
+        if (entry.end_ms < last_end_ms) {
+          entries.clear();
+        }
+        last_end_ms = entry.end_ms;
+        entries.push_back(entry);
+      }));
+
+  return Result::ok(std::move(entries));
+}
+
+runtime::Result<StepDurations, std::string>
+load_step_durations(const std::filesystem::path &log_path) noexcept {
+  StepDurations durations;
+  RESULT_PROPAGATE_DISCARD(
+      parse_ninja_log(log_path, [&](const NinjaLogEntry &entry) {
+        durations[entry.output] = entry.end_ms - entry.start_ms;
+      }));
+
+  return runtime::Result<StepDurations, std::string>::ok(std::move(durations));
+}
+
+} // namespace yabt::ninja
@@ -1,14 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <csignal>
 #include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "yabt/log/log.h"
 #include "yabt/process/process.h"
 #include "yabt/runtime/check.h"
 
 namespace yabt::process {
 
+namespace {
+
+constexpr static size_t READ_CHUNK_SIZE = 64 * 1024;
+
+constexpr static size_t MAX_INTERRUPT_TARGETS = 4096;
+
+constexpr static pid_t FREE_SLOT = 0;
+constexpr static pid_t RESERVED_SLOT = std::numeric_limits<pid_t>::min();
+
+volatile sig_atomic_t g_interrupted = 0;
+
+// Where forwarded signals are sent, one slot per running child: its pid, or
+// its negated process group id when it runs in its own group
+std::array<std::atomic<pid_t>, MAX_INTERRUPT_TARGETS> g_interrupt_targets{};
+
+void forward_signal(const int signal, siginfo_t *info, void *) {
+  const int saved_errno = errno;
+  g_interrupted = 1;
+  // Signals from the terminal already reached the children in its foreground
+  // group, which is yabt's
+  const bool from_terminal = info->si_code == SI_KERNEL;
+  for (const std::atomic<pid_t> &target : g_interrupt_targets) {
+    const pid_t pid = target.load();
+    if (pid == FREE_SLOT || pid == RESERVED_SLOT ||
+        (from_terminal && pid > 0)) {
+      continue;
+    }
+    kill(pid, signal);
+  }
+  errno = saved_errno;
+}
+
+[[nodiscard]] std::optional<size_t> reserve_interrupt_slot() noexcept {
+  for (size_t i = 0; i < g_interrupt_targets.size(); i++) {
+    pid_t expected = FREE_SLOT;
+    if (g_interrupt_targets[i].compare_exchange_strong(expected,
+                                                       RESERVED_SLOT)) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] std::chrono::microseconds to_duration(const timeval &time) {
+  return std::chrono::seconds{time.tv_sec} +
+         std::chrono::microseconds{time.tv_usec};
+}
+
+[[nodiscard]] double to_seconds(const std::chrono::microseconds time) {
+  return std::chrono::duration<double>{time}.count();
+}
+
+} // namespace
+
+void forward_interrupts() noexcept {
+  struct sigaction action{};
+  action.sa_sigaction = forward_signal;
+  action.sa_flags = SA_RESTART | SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  for (const int signal : {SIGINT, SIGTERM}) {
+    runtime::check(sigaction(signal, &action, nullptr) == 0,
+                   "Unable to install signal handler: {}", strerror(errno));
+  }
+}
+
+bool interrupted() noexcept { return g_interrupted != 0; }
+
+std::string Process::ResourceUsage::summary() const noexcept {
+  return std::format("wall {:.2f}s, user {:.2f}s, sys {:.2f}s, max RSS {} MiB",
+                     to_seconds(wall_time), to_seconds(user_time),
+                     to_seconds(system_time), max_rss_kib / 1024);
+}
+
 runtime::Result<void, std::string>
 Process::ProcessOutput::to_result() const noexcept {
+  if (timed_out) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Timed out\nstderr: {}", stderr.value_or("")));
+  }
+
   return std::visit(
       [this]<typename T>(const T v) {
         if constexpr (std::same_as<T, NormalExit>) {
@@ -46,69 +135,147 @@ void Process::set_cwd(const std::string_view path) {
   m_cwd = path;
 }
 
+void Process::set_env(const std::string_view name,
+                      const std::string_view value) {
+  yabt::runtime::check(
+      m_status == Status::CREATED,
+      "Attempted to set env on a Process that is not in the CREATED status");
+  m_env.push_back(std::format("{}={}", name, value));
+}
+
+void Process::set_line_callback(LineCallback callback) {
+  yabt::runtime::check(m_status == Status::CREATED,
+                       "Attempted to set the line callback on a Process that "
+                       "is not in the CREATED status");
+  m_line_callback = std::move(callback);
+}
+
+void Process::set_timeout(const std::chrono::milliseconds timeout) {
+  yabt::runtime::check(m_status == Status::CREATED,
+                       "Attempted to set the timeout on a Process that is not "
+                       "in the CREATED status");
+  m_timeout = timeout;
+}
+
 [[nodiscard]] runtime::Result<void, std::string>
 Process::start(const bool capture_stdout) noexcept {
   yabt::runtime::check(m_status == Status::CREATED,
                        "Process is not in the created status");
 
+  // Taken before starting the child, so that every running child can be
+  // reached by forwarded signals
+  m_interrupt_slot = reserve_interrupt_slot();
+  if (!m_interrupt_slot.has_value()) {
+    return yabt::runtime::Result<void, std::string>::error(std::format(
+        "Failed to start {}: more than {} processes are running", m_exe,
+        MAX_INTERRUPT_TARGETS));
+  }
+
   std::array<int, 2> stdout_pipes{-1, -1};
   std::array<int, 2> stderr_pipes{-1, -1};
 
+  // posix_spawn uses vfork semantics, so starting a process does not copy the
+  // page tables of yabt, which can be large after evaluating the build files.
+  posix_spawn_file_actions_t file_actions;
+  runtime::check(posix_spawn_file_actions_init(&file_actions) == 0,
+                 "Unable to initialize spawn file actions");
+
   if (capture_stdout) {
-    if (pipe(stdout_pipes.data()) != 0) {
+    // The pipes are close-on-exec, only the duplicated ends reach the child
+    if (pipe2(stdout_pipes.data(), O_CLOEXEC) != 0) {
       runtime::fatal("Unable to create pipe: {}", strerror(errno));
     }
 
-    if (pipe(stderr_pipes.data()) != 0) {
+    if (pipe2(stderr_pipes.data(), O_CLOEXEC) != 0) {
       runtime::fatal("Unable to create pipe: {}", strerror(errno));
     }
 
     m_stdout_read_pipe = stdout_pipes[0];
     m_stderr_read_pipe = stderr_pipes[0];
-  }
+    m_captured = true;
 
-  const pid_t pid = fork();
-  if (pid == -1) {
-    return yabt::runtime::Result<void, std::string>::error(
-        std::format("Failed to fork process: {}", strerror(errno)));
+    posix_spawn_file_actions_adddup2(&file_actions, stdout_pipes[1],
+                                     STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&file_actions, stderr_pipes[1],
+                                     STDERR_FILENO);
   }
 
-  if (pid == 0) {
-    std::vector<const char *> args{m_exe.c_str()};
-    args.reserve(1 + m_args.size());
-    for (const std::string &arg : m_args) {
-      args.push_back(arg.c_str());
-    }
-    args.push_back(nullptr);
+  if (m_cwd.has_value()) {
+    posix_spawn_file_actions_addchdir_np(&file_actions, m_cwd.value().c_str());
+  }
 
-    if (capture_stdout) {
-      dup2(stdout_pipes[1], STDOUT_FILENO);
-      dup2(stderr_pipes[1], STDERR_FILENO);
+  std::vector<char *> args{m_exe.data()};
+  args.reserve(2 + m_args.size());
+  for (std::string &arg : m_args) {
+    args.push_back(arg.data());
+  }
+  args.push_back(nullptr);
+
+  // A captured process with a timeout gets its own process group, so that
+  // terminating it also terminates anything it started. Uncaptured ones may
+  // read from the terminal, which stops processes in background groups.
+  posix_spawnattr_t attributes;
+  runtime::check(posix_spawnattr_init(&attributes) == 0,
+                 "Unable to initialize spawn attributes");
+  m_own_group = m_timeout.has_value() && capture_stdout;
+  if (m_own_group) {
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+  }
 
-      close(stdout_pipes[0]);
-      close(stdout_pipes[1]);
-      close(stderr_pipes[0]);
-      close(stderr_pipes[1]);
+  std::vector<char *> env{};
+  if (!m_env.empty()) {
+    for (char **var = environ; *var != nullptr; var++) {
+      const std::string_view name =
+          std::string_view{*var}.substr(0, std::string_view{*var}.find('='));
+      const bool overridden =
+          std::any_of(m_env.cbegin(), m_env.cend(), [name](const auto &e) {
+            return e.starts_with(name) && e.size() > name.size() &&
+                   e[name.size()] == '=';
+          });
+      if (!overridden) {
+        env.push_back(*var);
+      }
     }
-
-    if (m_cwd.has_value()) {
-      runtime::check(chdir(m_cwd.value().c_str()) == 0,
-                     "Chdir to {} failed with: {}", m_cwd.value(),
-                     strerror(errno));
+    for (std::string &var : m_env) {
+      env.push_back(var.data());
     }
-
-    execvp(m_exe.c_str(), const_cast<char *const *>(args.data()));
-    runtime::fatal("Child failed to start program: {}", strerror(errno));
+    env.push_back(nullptr);
   }
 
-  m_status = Status::RUNNING;
-  m_child_pid = pid;
+  m_start_time = std::chrono::steady_clock::now();
+  pid_t pid;
+  const int spawn_result =
+      posix_spawnp(&pid, m_exe.c_str(), &file_actions, &attributes,
+                   args.data(), m_env.empty() ? environ : env.data());
+  posix_spawn_file_actions_destroy(&file_actions);
+  posix_spawnattr_destroy(&attributes);
 
   if (capture_stdout) {
     close(stdout_pipes[1]);
     close(stderr_pipes[1]);
   }
 
+  if (spawn_result != 0) {
+    if (capture_stdout) {
+      close(m_stdout_read_pipe);
+      close(m_stderr_read_pipe);
+      m_stdout_read_pipe = -1;
+      m_stderr_read_pipe = -1;
+    }
+    g_interrupt_targets[m_interrupt_slot.value()] = FREE_SLOT;
+    m_interrupt_slot.reset();
+    return yabt::runtime::Result<void, std::string>::error(
+        std::format("Failed to start {}: {}", m_exe, strerror(spawn_result)));
+  }
+
+  m_status = Status::RUNNING;
+  m_child_pid = pid;
+  g_interrupt_targets[m_interrupt_slot.value()] = m_own_group ? -pid : pid;
+  if (m_timeout.has_value()) {
+    m_deadline = m_start_time + m_timeout.value();
+  }
+
   return yabt::runtime::Result<void, std::string>::ok();
 }
 
@@ -116,17 +283,32 @@ Process::start(const bool capture_stdout) noexcept {
   yabt::runtime::check(m_status == Status::RUNNING,
                        "Process is not in the running status");
 
+  rusage usage{};
   while (true) {
-    int result = waitpid(m_child_pid, &m_exit_code, 0);
+    int result = wait4(m_child_pid, &m_exit_code, 0, &usage);
     if (result != -1) {
       break;
     }
 
     result = errno;
-    runtime::check(result == EINTR, "Unexpected return value from waitpid: {}",
+    runtime::check(result == EINTR, "Unexpected return value from wait4: {}",
                    strerror(result));
   }
   m_status = Status::FINISHED;
+  m_deadline.reset();
+  if (m_interrupt_slot.has_value()) {
+    g_interrupt_targets[m_interrupt_slot.value()] = FREE_SLOT;
+    m_interrupt_slot.reset();
+  }
+
+  m_resource_usage = ResourceUsage{
+      .wall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - m_start_time),
+      .user_time = to_duration(usage.ru_utime),
+      .system_time = to_duration(usage.ru_stime),
+      .max_rss_kib = usage.ru_maxrss,
+  };
+  yabt_verbose("{} finished: {}", m_exe, m_resource_usage.summary());
 
   Process::ExitReason exit_reason{};
 
@@ -144,46 +326,172 @@ Process::start(const bool capture_stdout) noexcept {
   return exit_reason;
 }
 
+int Process::output_fd(const Stream stream) const noexcept {
+  return stream == Stream::STDOUT ? m_stdout_read_pipe : m_stderr_read_pipe;
+}
+
+[[nodiscard]] bool Process::read_output(const Stream stream) noexcept {
+  int &fd = stream == Stream::STDOUT ? m_stdout_read_pipe : m_stderr_read_pipe;
+  std::string &buffer =
+      stream == Stream::STDOUT ? m_stdout_buffer : m_stderr_buffer;
+  yabt::runtime::check(fd >= 0, "Attempted to read from a closed stream");
+
+  const size_t offset = buffer.size();
+  buffer.resize(offset + READ_CHUNK_SIZE);
+
+  const ssize_t n_read = read(fd, buffer.data() + offset, READ_CHUNK_SIZE);
+  if (n_read < 0) {
+    buffer.resize(offset);
+    runtime::check(errno == EINTR, "Unexpected error reading from pipe: {}",
+                   strerror(errno));
+    return true;
+  }
+  buffer.resize(offset + n_read);
+
+  if (n_read == 0) {
+    close(fd);
+    fd = -1;
+  }
+
+  if (!m_line_callback) {
+    return n_read != 0;
+  }
+
+  // Only complete lines are handed out, the rest stays in the buffer
+  size_t line_start = 0;
+  for (size_t newline = buffer.find('\n', offset);
+       newline != std::string::npos; newline = buffer.find('\n', line_start)) {
+    m_line_callback(stream, std::string_view{buffer}.substr(
+                                line_start, newline - line_start));
+    line_start = newline + 1;
+  }
+  if (n_read == 0 && line_start < buffer.size()) {
+    m_line_callback(stream, std::string_view{buffer}.substr(line_start));
+    line_start = buffer.size();
+  }
+  buffer.erase(0, line_start);
+
+  return n_read != 0;
+}
+
+[[nodiscard]] Process::ProcessOutput Process::finish() noexcept {
+  yabt::runtime::check(m_stdout_read_pipe < 0 && m_stderr_read_pipe < 0,
+                       "Attempted to finish a process with unread output");
+
+  ProcessOutput output;
+  if (m_captured) {
+    output.stdout = std::move(m_stdout_buffer);
+    output.stderr = std::move(m_stderr_buffer);
+  }
+  output.exit_reason = wait_completion();
+  output.resource_usage = m_resource_usage;
+  output.timed_out = m_timed_out;
+  return output;
+}
+
+int Process::ms_until_deadline() const noexcept {
+  if (!m_deadline.has_value()) {
+    return -1;
+  }
+  const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      m_deadline.value() - std::chrono::steady_clock::now());
+  return static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+}
+
+void Process::enforce_timeout() noexcept {
+  const auto now = std::chrono::steady_clock::now();
+  if (!m_deadline.has_value() || now < m_deadline.value()) {
+    return;
+  }
+
+  if (!m_timed_out) {
+    yabt_warn("{} timed out after {:.1f}s, terminating it", m_exe,
+              std::chrono::duration<double>{m_timeout.value()}.count());
+    m_timed_out = true;
+    m_deadline = now + KILL_GRACE_PERIOD;
+    kill(m_own_group ? -m_child_pid : m_child_pid, SIGTERM);
+  } else {
+    yabt_warn("{} did not exit after SIGTERM, killing it", m_exe);
+    m_deadline.reset();
+    kill(m_own_group ? -m_child_pid : m_child_pid, SIGKILL);
+  }
+}
+
+int Process::open_pidfd() const noexcept {
+#ifdef SYS_pidfd_open
+  return static_cast<int>(syscall(SYS_pidfd_open, m_child_pid, 0));
+#else
+  return -1;
+#endif
+}
+
+bool Process::has_exited() const noexcept {
+  siginfo_t info{};
+  return waitid(P_PID, m_child_pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 &&
+         info.si_pid != 0;
+}
+
 [[nodiscard]] Process::ProcessOutput Process::process_output() noexcept {
   yabt::runtime::check(m_status == Status::RUNNING,
                        "Process is not in the running status");
-  ProcessOutput output;
 
-  const auto read_stream = [](int fd, std::string &stream) {
-    while (true) {
-      const size_t offset = stream.size();
+  // Both pipes are drained at the same time, otherwise a child filling one of
+  // them blocks while yabt waits for EOF on the other one.
+  constexpr static std::array<Stream, 2> STREAMS{Stream::STDOUT,
+                                                 Stream::STDERR};
+
+  // With a timeout, the exit has to be observed here too, since the deadline
+  // cannot be enforced while blocked in wait4.
+  const bool wait_exit = m_deadline.has_value();
+  const int pidfd = wait_exit ? open_pidfd() : -1;
+  bool exited = !wait_exit;
+  std::array<pollfd, 3> fds{
+      pollfd{.fd = m_stdout_read_pipe, .events = POLLIN, .revents = 0},
+      pollfd{.fd = m_stderr_read_pipe, .events = POLLIN, .revents = 0},
+      pollfd{.fd = pidfd, .events = POLLIN, .revents = 0},
+  };
+
+  // poll ignores negative file descriptors
+  while (fds[0].fd >= 0 || fds[1].fd >= 0 || !exited) {
+    int timeout_ms = ms_until_deadline();
+    if (!exited && pidfd < 0) {
+      const int interval = static_cast<int>(EXIT_POLL_INTERVAL.count());
+      timeout_ms = timeout_ms < 0 ? interval : std::min(timeout_ms, interval);
+    }
 
-      constexpr static size_t BUF_SIZE = 1024;
-      stream.resize(offset + BUF_SIZE);
+    if (poll(fds.data(), fds.size(), timeout_ms) < 0) {
+      runtime::check(errno == EINTR, "Unexpected error polling pipes: {}",
+                     strerror(errno));
+      continue;
+    }
+    enforce_timeout();
 
-      const ssize_t n_read = read(fd, stream.data() + offset, BUF_SIZE);
-      if (n_read < 0) {
-        runtime::fatal("Unexpected error reading from pipe: {}",
-                       strerror(errno));
+    for (size_t i = 0; i < STREAMS.size(); i++) {
+      if (fds[i].fd >= 0 && fds[i].revents != 0 && !read_output(STREAMS[i])) {
+        fds[i].fd = -1;
       }
-      if (n_read == 0) {
-        stream.resize(offset);
-        break;
-      }
-
-      stream.resize(offset + n_read);
     }
-  };
 
-  if (m_stdout_read_pipe >= 0) {
-    output.stdout.emplace();
-    read_stream(m_stdout_read_pipe, output.stdout.value());
-  }
-  if (m_stderr_read_pipe >= 0) {
-    output.stderr.emplace();
-    read_stream(m_stderr_read_pipe, output.stderr.value());
+    if (fds[2].fd >= 0 && fds[2].revents != 0) {
+      fds[2].fd = -1;
+      exited = true;
+    } else if (!exited && pidfd < 0) {
+      exited = has_exited();
+    }
   }
-  output.exit_reason = wait_completion();
 
-  return output;
+  if (pidfd >= 0) {
+    close(pidfd);
+  }
+  return finish();
 }
 
 Process::~Process() noexcept {
+  for (const int fd : {m_stdout_read_pipe, m_stderr_read_pipe}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
   if (m_status == Status::RUNNING) {
     static_cast<void>(wait_completion());
   }
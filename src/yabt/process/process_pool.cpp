@@ -0,0 +1,213 @@
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include "yabt/process/process_pool.h"
+#include "yabt/runtime/check.h"
+
+namespace yabt::process {
+
+namespace {
+
+constexpr static size_t MAX_EVENTS = 32;
+
+// Shortest of two poll timeouts, where -1 waits forever
+[[nodiscard]] int min_timeout(const int a, const int b) noexcept {
+  if (a < 0 || b < 0) {
+    return std::max(a, b);
+  }
+  return std::min(a, b);
+}
+
+} // namespace
+
+ProcessPool::ProcessPool(const size_t max_concurrency) noexcept
+    : m_max_concurrency{std::max<size_t>(max_concurrency, 1)},
+      m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)} {
+  runtime::check(m_epoll_fd >= 0, "Unable to create epoll instance: {}",
+                 strerror(errno));
+}
+
+ProcessPool::~ProcessPool() noexcept {
+  for (const std::unique_ptr<Job> &job : m_running) {
+    if (job->pidfd >= 0) {
+      close(job->pidfd);
+    }
+  }
+  close(m_epoll_fd);
+}
+
+void ProcessPool::submit(std::unique_ptr<Process> process,
+                         const bool capture_output, CompletionCallback callback,
+                         const int64_t priority) {
+  const auto position = std::find_if(
+      m_pending.cbegin(), m_pending.cend(),
+      [priority](const std::unique_ptr<Job> &job) {
+        return job->priority < priority;
+      });
+  m_pending.insert(position, std::unique_ptr<Job>{new Job{
+                                 .process = std::move(process),
+                                 .capture_output = capture_output,
+                                 .callback = std::move(callback),
+                                 .priority = priority,
+                             }});
+}
+
+void ProcessPool::submit_first(std::unique_ptr<Process> process,
+                               const bool capture_output,
+                               CompletionCallback callback) {
+  m_pending.push_front(std::unique_ptr<Job>{new Job{
+      .process = std::move(process),
+      .capture_output = capture_output,
+      .callback = std::move(callback),
+      .priority = std::numeric_limits<int64_t>::max(),
+  }});
+}
+
+void ProcessPool::set_max_concurrency(const size_t max_concurrency) noexcept {
+  m_max_concurrency = std::max<size_t>(max_concurrency, 1);
+}
+
+void ProcessPool::watch(const int fd, EventSource &source) noexcept {
+  epoll_event event{.events = EPOLLIN, .data{.ptr = &source}};
+  runtime::check(epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0,
+                 "Unable to watch file descriptor: {}", strerror(errno));
+}
+
+void ProcessPool::unwatch(const int fd) noexcept {
+  runtime::check(epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr) == 0,
+                 "Unable to unwatch file descriptor: {}", strerror(errno));
+}
+
+void ProcessPool::start_pending() noexcept {
+  while (m_running.size() < m_max_concurrency && !m_pending.empty()) {
+    std::unique_ptr<Job> job = std::move(m_pending.front());
+    m_pending.pop_front();
+
+    // Once yabt is interrupted, nothing new is started
+    if (interrupted()) {
+      job->callback(
+          runtime::Result<Process::ProcessOutput, std::string>::error(
+              "Interrupted"));
+      continue;
+    }
+
+    if (runtime::Result result = job->process->start(job->capture_output);
+        result.is_error()) {
+      job->callback(
+          runtime::Result<Process::ProcessOutput, std::string>::error(
+              std::move(result).error_value()));
+      continue;
+    }
+
+    job->sources = {
+        EventSource{job.get(), EventSource::Kind::STDOUT},
+        EventSource{job.get(), EventSource::Kind::STDERR},
+        EventSource{job.get(), EventSource::Kind::EXIT},
+    };
+    if (const int fd = job->process->output_fd(Process::Stream::STDOUT);
+        fd >= 0) {
+      watch(fd, job->sources[0]);
+    }
+    if (const int fd = job->process->output_fd(Process::Stream::STDERR);
+        fd >= 0) {
+      watch(fd, job->sources[1]);
+    }
+    job->pidfd = job->process->open_pidfd();
+    if (job->pidfd >= 0) {
+      watch(job->pidfd, job->sources[2]);
+    }
+
+    m_running.push_back(std::move(job));
+  }
+}
+
+runtime::Result<void, std::string> ProcessPool::wait_events() noexcept {
+  int timeout_ms = -1;
+  for (const std::unique_ptr<Job> &job : m_running) {
+    timeout_ms = min_timeout(timeout_ms, job->process->ms_until_deadline());
+    if (!job->exited && job->pidfd < 0) {
+      timeout_ms = min_timeout(
+          timeout_ms, static_cast<int>(Process::EXIT_POLL_INTERVAL.count()));
+    }
+  }
+
+  std::array<epoll_event, MAX_EVENTS> events;
+  const int num_events =
+      epoll_wait(m_epoll_fd, events.data(), events.size(), timeout_ms);
+  for (const std::unique_ptr<Job> &job : m_running) {
+    job->process->enforce_timeout();
+  }
+  if (num_events < 0) {
+    if (errno == EINTR) {
+      return runtime::Result<void, std::string>::ok();
+    }
+    return runtime::Result<void, std::string>::error(
+        std::format("Error waiting for processes: {}", strerror(errno)));
+  }
+
+  for (int i = 0; i < num_events; i++) {
+    const EventSource &source =
+        *static_cast<const EventSource *>(events[i].data.ptr);
+    Job &job = *source.job;
+
+    switch (source.kind) {
+    case EventSource::Kind::STDOUT:
+      // Reaching EOF closes the pipe, which removes it from the epoll set
+      static_cast<void>(job.process->read_output(Process::Stream::STDOUT));
+      break;
+    case EventSource::Kind::STDERR:
+      static_cast<void>(job.process->read_output(Process::Stream::STDERR));
+      break;
+    case EventSource::Kind::EXIT:
+      unwatch(job.pidfd);
+      close(job.pidfd);
+      job.pidfd = -1;
+      job.exited = true;
+      break;
+    }
+  }
+
+  return runtime::Result<void, std::string>::ok();
+}
+
+void ProcessPool::complete_finished() noexcept {
+  std::vector<std::unique_ptr<Job>> finished;
+  for (std::unique_ptr<Job> &job : m_running) {
+    if (!job->exited && job->pidfd < 0) {
+      job->exited = job->process->has_exited();
+    }
+    if (job->exited &&
+        job->process->output_fd(Process::Stream::STDOUT) < 0 &&
+        job->process->output_fd(Process::Stream::STDERR) < 0) {
+      finished.push_back(std::move(job));
+    }
+  }
+  std::erase(m_running, nullptr);
+
+  // Callbacks run last, since they may submit new processes
+  for (const std::unique_ptr<Job> &job : finished) {
+    job->callback(runtime::Result<Process::ProcessOutput, std::string>::ok(
+        job->process->finish()));
+  }
+}
+
+runtime::Result<void, std::string> ProcessPool::run() noexcept {
+  while (!m_pending.empty() || !m_running.empty()) {
+    start_pending();
+    if (m_running.empty()) {
+      continue;
+    }
+
+    RESULT_PROPAGATE_DISCARD(wait_events());
+    complete_finished();
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::process
@@ -1,6 +1,38 @@
 local gtest = require 'yabt.gtest'
 
+local yabt = import 'yabt'
+
 targets.BasicTest = gtest.GtestBinary:new {
     out = out('basic_test'),
     srcs = ins('basic_test.cpp'),
 }
+
+targets.TargetMatcherTest = gtest.GtestBinary:new {
+    out = out('target_matcher_test'),
+    srcs = ins('target_matcher_test.cpp'),
+    deps = { yabt.Lib },
+}
+
+targets.Sha256Test = gtest.GtestBinary:new {
+    out = out('sha256_test'),
+    srcs = ins('sha256_test.cpp'),
+    deps = { yabt.Lib },
+}
+
+targets.TestCacheTest = gtest.GtestBinary:new {
+    out = out('test_cache_test'),
+    srcs = ins('test_cache_test.cpp'),
+    deps = { yabt.Lib },
+}
+
+targets.ArchiveModuleTest = gtest.GtestBinary:new {
+    out = out('archive_module_test'),
+    srcs = ins('archive_module_test.cpp'),
+    deps = { yabt.Lib },
+}
+
+targets.LocalModuleTest = gtest.GtestBinary:new {
+    out = out('local_module_test'),
+    srcs = ins('local_module_test.cpp'),
+    deps = { yabt.Lib },
+}
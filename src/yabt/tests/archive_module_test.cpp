@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unistd.h>
+
+#include "yabt/module/archive_module.h"
+#include "yabt/utils/sha256.h"
+
+using yabt::module::ArchiveModule;
+
+namespace {
+
+class ArchiveModuleTest : public testing::Test {
+protected:
+  void SetUp() override {
+    m_dir = std::filesystem::temp_directory_path() /
+            std::format("yabt_archive_module_test_{}", getpid());
+    std::filesystem::create_directories(m_dir / "src/pkg-1.0/sub");
+    std::filesystem::create_directories(m_dir / "DEPS");
+    write("src/pkg-1.0/top.txt", "top");
+    write("src/pkg-1.0/sub/nested.txt", "nested");
+    ASSERT_EQ(std::system(std::format("tar -cf {} -C {} pkg-1.0",
+                                      archive().native(),
+                                      (m_dir / "src").native())
+                              .c_str()),
+              0);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+  void write(const std::string &name, const std::string &contents) {
+    std::ofstream{m_dir / name} << contents;
+  }
+
+  [[nodiscard]] std::string read(const std::filesystem::path &path) {
+    std::ifstream stream{path};
+    return {std::istreambuf_iterator<char>{stream},
+            std::istreambuf_iterator<char>{}};
+  }
+
+  [[nodiscard]] std::filesystem::path archive() const {
+    return m_dir / "pkg-1.0.tar";
+  }
+
+  [[nodiscard]] std::string url() const {
+    return "file://" + archive().native();
+  }
+
+  [[nodiscard]] std::string archive_hash() const {
+    yabt::utils::Sha256 sha256;
+    EXPECT_TRUE(yabt::utils::update_with_file(sha256, archive()).is_ok());
+    return sha256.hex_digest();
+  }
+
+  [[nodiscard]] std::filesystem::path mod_dir() const {
+    return m_dir / "DEPS/pkg";
+  }
+
+  std::filesystem::path m_dir;
+};
+
+} // namespace
+
+TEST_F(ArchiveModuleTest, ExtractsWithoutTopLevelDirectory) {
+  const std::string hash = archive_hash();
+  auto result = ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                    m_dir / "cache");
+  ASSERT_TRUE(result.is_ok()) << result.error_value();
+
+  EXPECT_EQ(read(mod_dir() / "top.txt"), "top");
+  EXPECT_EQ(read(mod_dir() / "sub/nested.txt"), "nested");
+  EXPECT_FALSE(std::filesystem::exists(mod_dir() / "pkg-1.0"));
+  EXPECT_FALSE(std::filesystem::exists(mod_dir().native() + ".partial"));
+
+  auto head = result.ok_value()->head();
+  ASSERT_TRUE(head.is_ok());
+  EXPECT_EQ(head.ok_value(), hash);
+}
+
+TEST_F(ArchiveModuleTest, SharedCacheOnlyWhenGiven) {
+  const std::string hash = archive_hash();
+  ASSERT_TRUE(ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                  m_dir / "cache")
+                  .is_ok());
+  EXPECT_TRUE(std::filesystem::exists(m_dir / "cache/archives" / hash));
+  EXPECT_FALSE(std::filesystem::exists(m_dir / "DEPS/archives"));
+
+  std::filesystem::remove_all(mod_dir());
+  ASSERT_TRUE(ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                  std::nullopt)
+                  .is_ok());
+  EXPECT_TRUE(std::filesystem::exists(m_dir / "DEPS/archives" / hash));
+}
+
+TEST_F(ArchiveModuleTest, ReusesCachedArchive) {
+  const std::string hash = archive_hash();
+  ASSERT_TRUE(ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                  m_dir / "cache")
+                  .is_ok());
+
+  // The cached archive is extracted again without being downloaded
+  std::filesystem::remove_all(mod_dir());
+  std::filesystem::remove(archive());
+  auto result = ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                    m_dir / "cache");
+  ASSERT_TRUE(result.is_ok()) << result.error_value();
+  EXPECT_EQ(read(mod_dir() / "top.txt"), "top");
+}
+
+TEST_F(ArchiveModuleTest, RejectsMismatchingHash) {
+  const std::string hash(64, '0');
+  auto result = ArchiveModule::open_or_fetch_module(mod_dir(), url(), hash,
+                                                    m_dir / "cache");
+  ASSERT_TRUE(result.is_error());
+  EXPECT_NE(result.error_value().find("was expected"), std::string::npos);
+  EXPECT_FALSE(std::filesystem::exists(mod_dir()));
+  EXPECT_FALSE(std::filesystem::exists(m_dir / "cache/archives" / hash));
+}
+
+TEST_F(ArchiveModuleTest, RejectsInvalidHash) {
+  EXPECT_TRUE(ArchiveModule::open_or_fetch_module(mod_dir(), url(), "",
+                                                  m_dir / "cache")
+                  .is_error());
+  EXPECT_TRUE(ArchiveModule::open_or_fetch_module(mod_dir(), url(),
+                                                  "../../escape",
+                                                  m_dir / "cache")
+                  .is_error());
+  EXPECT_FALSE(std::filesystem::exists(m_dir / "cache"));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "yabt/module/local_module.h"
+#include "yabt/module/module.h"
+
+using yabt::module::LocalModule;
+
+namespace {
+
+class LocalModuleTest : public testing::Test {
+protected:
+  void SetUp() override {
+    m_dir = std::filesystem::temp_directory_path() /
+            std::format("yabt_local_module_test_{}", getpid());
+    std::filesystem::create_directories(m_dir / "ws/DEPS");
+    std::filesystem::create_directories(m_dir / "sibling");
+    std::filesystem::create_directories(m_dir / "other");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+  [[nodiscard]] std::filesystem::path mod_dir() const {
+    return m_dir / "ws/DEPS/sibling";
+  }
+
+  std::filesystem::path m_dir;
+};
+
+} // namespace
+
+TEST_F(LocalModuleTest, LinksRelativeToWorkspaceRoot) {
+  auto result = LocalModule::open_or_fetch_module(mod_dir(), "../sibling");
+  ASSERT_TRUE(result.is_ok()) << result.error_value();
+
+  ASSERT_TRUE(std::filesystem::is_symlink(mod_dir()));
+  EXPECT_EQ(std::filesystem::read_symlink(mod_dir()), m_dir / "sibling");
+  EXPECT_EQ(result.ok_value()->disk_path(), mod_dir());
+  EXPECT_FALSE(result.ok_value()->has_revisions());
+}
+
+TEST_F(LocalModuleTest, RelinksToNewPath) {
+  ASSERT_TRUE(
+      LocalModule::open_or_fetch_module(mod_dir(), "../sibling").is_ok());
+
+  auto result = LocalModule::open_or_fetch_module(
+      mod_dir(), "file://" + (m_dir / "other").native());
+  ASSERT_TRUE(result.is_ok()) << result.error_value();
+  EXPECT_EQ(std::filesystem::read_symlink(mod_dir()), m_dir / "other");
+}
+
+TEST_F(LocalModuleTest, RefusesExistingDirectory) {
+  std::filesystem::create_directories(mod_dir());
+  std::ofstream{mod_dir() / "local_change.txt"} << "change";
+
+  auto result = LocalModule::open_or_fetch_module(mod_dir(), "../sibling");
+  ASSERT_TRUE(result.is_error());
+  EXPECT_FALSE(std::filesystem::is_symlink(mod_dir()));
+  EXPECT_TRUE(std::filesystem::exists(mod_dir() / "local_change.txt"));
+}
+
+TEST_F(LocalModuleTest, RefusesMissingDirectory) {
+  EXPECT_TRUE(
+      LocalModule::open_or_fetch_module(mod_dir(), "../missing").is_error());
+  EXPECT_FALSE(std::filesystem::exists(mod_dir()));
+}
+
+TEST_F(LocalModuleTest, ResolvesFromDeclaringModule) {
+  // The sibling declares its own local dependency, next to itself
+  ASSERT_TRUE(
+      LocalModule::open_or_fetch_module(mod_dir(), "../sibling").is_ok());
+  const std::filesystem::path real_dir =
+      std::filesystem::canonical(m_dir / "other");
+  EXPECT_EQ(yabt::module::resolve_url(mod_dir(), "../other", "Local"),
+            real_dir.native());
+  EXPECT_EQ(yabt::module::resolve_url(mod_dir(), "file://../other", "local"),
+            real_dir.native());
+
+  EXPECT_EQ(yabt::module::resolve_url(mod_dir(), "/abs/path", "Local"),
+            "/abs/path");
+  EXPECT_EQ(yabt::module::resolve_url(mod_dir(), "../repo.git", "Git"),
+            "../repo.git");
+}
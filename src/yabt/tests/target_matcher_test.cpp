@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "yabt/build/target_matcher.h"
+
+using yabt::build::TargetMatcher;
+
+namespace {
+
+const std::vector<std::string> TARGETS{
+    "//yabt/Bin",           "//yabt/embed/Blob",    "//yabt/tests/BasicTest",
+    "//yabt/tests/MoreTest", "//yabtx/Bin",          "//other/lib/Lib",
+    "//other/lib/sub/Lib",  "//other/library/Lib",
+};
+
+std::vector<std::string>
+match(const std::vector<std::string_view> &patterns,
+      const std::vector<std::string> &targets = TARGETS) {
+  auto result = TargetMatcher::compile(patterns);
+  if (result.is_error()) {
+    ADD_FAILURE() << "Failed to compile patterns: " << result.error_value();
+    return {};
+  }
+  return result.ok_value().match(targets);
+}
+
+} // namespace
+
+TEST(TargetMatcherTest, ExactSpec) {
+  EXPECT_EQ(match({"//yabt/Bin"}), std::vector<std::string>{"//yabt/Bin"});
+  EXPECT_EQ(match({"//yabt/Missing"}), std::vector<std::string>{});
+}
+
+TEST(TargetMatcherTest, RecursiveSpec) {
+  EXPECT_EQ(match({"//other/lib/..."}),
+            (std::vector<std::string>{"//other/lib/Lib",
+                                      "//other/lib/sub/Lib"}));
+}
+
+TEST(TargetMatcherTest, AnySuffix) {
+  EXPECT_EQ(match({"//yabt/tests/.*"}),
+            (std::vector<std::string>{"//yabt/tests/BasicTest",
+                                      "//yabt/tests/MoreTest"}));
+  EXPECT_EQ(match({".*"}), TARGETS);
+}
+
+TEST(TargetMatcherTest, RegexFallback) {
+  EXPECT_EQ(match({"//yabt/tests/[A-Z][a-z]+Test"}),
+            (std::vector<std::string>{"//yabt/tests/BasicTest",
+                                      "//yabt/tests/MoreTest"}));
+  // Quantifiers and alternatives must not restrict the literal prefix
+  EXPECT_EQ(match({"//yabtx?/Bin"}),
+            (std::vector<std::string>{"//yabt/Bin", "//yabtx/Bin"}));
+  EXPECT_EQ(match({"//yabt/Bin|//other/lib/Lib"}),
+            (std::vector<std::string>{"//yabt/Bin", "//other/lib/Lib"}));
+}
+
+TEST(TargetMatcherTest, KeepsTargetOrderWithoutDuplicates) {
+  EXPECT_EQ(match({"//other/.*", "//yabt/Bin", "//other/lib/Lib"}),
+            (std::vector<std::string>{"//yabt/Bin", "//other/lib/Lib",
+                                      "//other/lib/sub/Lib",
+                                      "//other/library/Lib"}));
+}
+
+TEST(TargetMatcherTest, InvalidRegex) {
+  const std::vector<std::string_view> patterns{"//yabt/(Bin"};
+  EXPECT_TRUE(TargetMatcher::compile(patterns).is_error());
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "yabt/build/test_cache.h"
+
+using yabt::build::TestCache;
+using yabt::build::TestInputs;
+
+namespace {
+
+class TestCacheTest : public testing::Test {
+protected:
+  void SetUp() override {
+    m_dir = std::filesystem::temp_directory_path() /
+            std::format("yabt_test_cache_test_{}", getpid());
+    std::filesystem::create_directories(m_dir / "data");
+    write("test_bin", "binary");
+    write("data/input.txt", "input");
+  }
+
+  void TearDown() override { std::filesystem::remove_all(m_dir); }
+
+  void write(const std::string &name, const std::string &contents) {
+    std::ofstream{m_dir / name} << contents;
+  }
+
+  [[nodiscard]] std::string key(const std::vector<std::string> &argv) {
+    const TestInputs inputs{
+        .argv = argv,
+        .files{m_dir / "test_bin", m_dir / "data"},
+        .built_files{},
+    };
+    auto result = TestCache{m_dir / "cache"}.key(inputs);
+    if (result.is_error()) {
+      return "error: " + result.error_value();
+    }
+    return result.ok_value();
+  }
+
+  std::filesystem::path m_dir;
+};
+
+} // namespace
+
+TEST_F(TestCacheTest, SameInputsSameKey) {
+  const std::vector<std::string> argv{m_dir / "test_bin"};
+  EXPECT_EQ(key(argv), key(argv));
+}
+
+TEST_F(TestCacheTest, DataContentsChangeKey) {
+  const std::vector<std::string> argv{m_dir / "test_bin"};
+  const std::string before = key(argv);
+  write("data/input.txt", "changed");
+  EXPECT_NE(key(argv), before);
+}
+
+TEST_F(TestCacheTest, EnvironmentChangesKey) {
+  const std::vector<std::string> argv{m_dir / "test_bin"};
+  const std::string before = key(argv);
+  setenv("YABT_TEST_CACHE_TEST", "1", 1);
+  const std::string after = key(argv);
+  unsetenv("YABT_TEST_CACHE_TEST");
+  EXPECT_NE(after, before);
+}
+
+TEST_F(TestCacheTest, DeclaredArguments) {
+  const std::string data_flag = "--input=" + (m_dir / "data").native();
+  EXPECT_FALSE(key({m_dir / "test_bin", m_dir / "data/input.txt"})
+                   .starts_with("error"));
+  EXPECT_FALSE(key({m_dir / "test_bin", data_flag}).starts_with("error"));
+}
+
+TEST_F(TestCacheTest, UndeclaredArguments) {
+  write("other.txt", "other");
+  EXPECT_TRUE(
+      key({m_dir / "test_bin", m_dir / "other.txt"}).starts_with("error"));
+  const std::string other_flag = "--input=" + (m_dir / "other.txt").native();
+  EXPECT_TRUE(key({m_dir / "test_bin", other_flag}).starts_with("error"));
+  EXPECT_TRUE(key({m_dir / "test_bin", m_dir}).starts_with("error"));
+}
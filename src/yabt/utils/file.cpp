@@ -0,0 +1,103 @@
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "yabt/utils/file.h"
+
+namespace yabt::utils {
+
+[[nodiscard]] runtime::Result<bool, std::string>
+files_have_same_content(const std::filesystem::path &lhs,
+                        const std::filesystem::path &rhs) noexcept {
+  std::error_code error_code;
+  if (!std::filesystem::is_regular_file(lhs, error_code) ||
+      !std::filesystem::is_regular_file(rhs, error_code)) {
+    return runtime::Result<bool, std::string>::ok(false);
+  }
+
+  if (std::filesystem::file_size(lhs, error_code) !=
+      std::filesystem::file_size(rhs, error_code)) {
+    return runtime::Result<bool, std::string>::ok(false);
+  }
+  if (error_code) {
+    return runtime::Result<bool, std::string>::error(
+        std::format("Unable to get file size: {}", error_code.message()));
+  }
+
+  std::ifstream lhs_stream{lhs, std::ios::binary};
+  std::ifstream rhs_stream{rhs, std::ios::binary};
+  if (!lhs_stream || !rhs_stream) {
+    return runtime::Result<bool, std::string>::error(std::format(
+        "Unable to open {} or {} for reading", lhs.native(), rhs.native()));
+  }
+
+  constexpr static size_t BUF_SIZE = 64 * 1024;
+  std::array<char, BUF_SIZE> lhs_buf;
+  std::array<char, BUF_SIZE> rhs_buf;
+  while (lhs_stream && rhs_stream) {
+    lhs_stream.read(lhs_buf.data(), lhs_buf.size());
+    rhs_stream.read(rhs_buf.data(), rhs_buf.size());
+    if (lhs_stream.gcount() != rhs_stream.gcount()) {
+      return runtime::Result<bool, std::string>::ok(false);
+    }
+    if (memcmp(lhs_buf.data(), rhs_buf.data(), lhs_stream.gcount()) != 0) {
+      return runtime::Result<bool, std::string>::ok(false);
+    }
+  }
+
+  return runtime::Result<bool, std::string>::ok(true);
+}
+
+[[nodiscard]] std::optional<std::filesystem::path> user_cache_dir() noexcept {
+  if (const char *xdg_cache = std::getenv("XDG_CACHE_HOME");
+      xdg_cache != nullptr && *xdg_cache != '\0') {
+    return std::filesystem::path{xdg_cache} / "yabt";
+  }
+  if (const char *home = std::getenv("HOME");
+      home != nullptr && *home != '\0') {
+    return std::filesystem::path{home} / ".cache" / "yabt";
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] runtime::Result<FileLock, std::string>
+FileLock::acquire(const std::filesystem::path &path) noexcept {
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return runtime::Result<FileLock, std::string>::error(std::format(
+        "Unable to open lock file {}: {}", path.native(), strerror(errno)));
+  }
+
+  int result;
+  do {
+    result = flock(fd, LOCK_EX);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    const int error = errno;
+    close(fd);
+    return runtime::Result<FileLock, std::string>::error(std::format(
+        "Unable to lock {}: {}", path.native(), strerror(error)));
+  }
+
+  return runtime::Result<FileLock, std::string>::ok(FileLock{fd});
+}
+
+FileLock::FileLock(int fd) noexcept : m_fd{fd} {}
+
+FileLock::FileLock(FileLock &&other) noexcept : m_fd{other.m_fd} {
+  other.m_fd = -1;
+}
+
+FileLock::~FileLock() noexcept {
+  if (m_fd >= 0) {
+    // Closing the file releases the lock
+    close(m_fd);
+  }
+}
+
+} // namespace yabt::utils
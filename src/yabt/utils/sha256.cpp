@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <fstream>
+
+#include "yabt/utils/sha256.h"
+
+namespace yabt::utils {
+
+namespace {
+
+constexpr static std::array<uint32_t, 64> ROUND_CONSTANTS{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr static std::array<uint32_t, 8> INITIAL_STATE{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+} // namespace
+
+Sha256::Sha256() noexcept : m_state{INITIAL_STATE} {}
+
+void Sha256::process_block() noexcept {
+  std::array<uint32_t, 64> w;
+  for (size_t i = 0; i < 16; i++) {
+    w[i] = (uint32_t{m_block[4 * i]} << 24) |
+           (uint32_t{m_block[4 * i + 1]} << 16) |
+           (uint32_t{m_block[4 * i + 2]} << 8) | uint32_t{m_block[4 * i + 3]};
+  }
+  for (size_t i = 16; i < w.size(); i++) {
+    const uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^
+                        (w[i - 15] >> 3);
+    const uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^
+                        (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  auto [a, b, c, d, e, f, g, h] = m_state;
+  for (size_t i = 0; i < w.size(); i++) {
+    const uint32_t s1 = std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+    const uint32_t choice = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+    const uint32_t s0 = std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+    const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + majority;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  const std::array<uint32_t, 8> result{a, b, c, d, e, f, g, h};
+  for (size_t i = 0; i < m_state.size(); i++) {
+    m_state[i] += result[i];
+  }
+}
+
+void Sha256::update(const std::string_view data) noexcept {
+  m_total_size += data.size();
+  for (const char c : data) {
+    m_block[m_block_size++] = static_cast<uint8_t>(c);
+    if (m_block_size == m_block.size()) {
+      process_block();
+      m_block_size = 0;
+    }
+  }
+}
+
+std::string Sha256::hex_digest() noexcept {
+  const uint64_t total_bits = m_total_size * 8;
+
+  // Padding: a single 1 bit, zeros, and the message length in bits
+  m_block[m_block_size++] = 0x80;
+  if (m_block_size > m_block.size() - 8) {
+    std::fill(m_block.begin() + m_block_size, m_block.end(), 0);
+    process_block();
+    m_block_size = 0;
+  }
+  std::fill(m_block.begin() + m_block_size, m_block.end() - 8, 0);
+  for (size_t i = 0; i < 8; i++) {
+    m_block[m_block.size() - 1 - i] =
+        static_cast<uint8_t>(total_bits >> (8 * i));
+  }
+  process_block();
+
+  constexpr static std::string_view HEX_DIGITS = "0123456789abcdef";
+  std::string digest;
+  digest.reserve(2 * sizeof(m_state));
+  for (const uint32_t word : m_state) {
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      digest.push_back(HEX_DIGITS[(word >> shift) & 0xf]);
+    }
+  }
+  return digest;
+}
+
+runtime::Result<void, std::string>
+update_with_file(Sha256 &hash, const std::filesystem::path &path) noexcept {
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to open {} for reading", path.native()));
+  }
+
+  constexpr static size_t BUF_SIZE = 64 * 1024;
+  std::array<char, BUF_SIZE> buf;
+  while (stream) {
+    stream.read(buf.data(), buf.size());
+    hash.update(std::string_view{buf.data(),
+                                 static_cast<size_t>(stream.gcount())});
+  }
+  if (stream.bad()) {
+    return runtime::Result<void, std::string>::error(
+        std::format("Unable to read {}", path.native()));
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace yabt::utils
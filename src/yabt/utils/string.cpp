@@ -1,3 +1,4 @@
+#include <format>
 #include <string_view>
 
 #include "yabt/utils/string.h"
@@ -29,4 +30,61 @@ trim_right_charset(std::string_view sv, std::string_view chars) noexcept {
   return sv.substr(0, n + 1);
 }
 
+[[nodiscard]] std::string
+json_escape(const std::string_view unescaped) noexcept {
+  std::string escaped;
+
+  escaped.reserve(unescaped.size());
+  for (const char c : unescaped) {
+    if (c == '"') {
+      escaped += "\\\"";
+    } else if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\b') {
+      escaped += "\\b";
+    } else if (c == '\r') {
+      escaped += "\\r";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else if (c == '\f') {
+      escaped += "\\f";
+    } else if (c == '\t') {
+      escaped += "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      escaped += std::format("\\u{:04x}", static_cast<unsigned>(c));
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+[[nodiscard]] std::string
+xml_escape(const std::string_view unescaped) noexcept {
+  std::string escaped;
+
+  escaped.reserve(unescaped.size());
+  for (const char c : unescaped) {
+    if (c == '<') {
+      escaped += "&lt;";
+    } else if (c == '>') {
+      escaped += "&gt;";
+    } else if (c == '&') {
+      escaped += "&amp;";
+    } else if (c == '"') {
+      escaped += "&quot;";
+    } else if (c == '\'') {
+      escaped += "&apos;";
+    } else if (static_cast<unsigned char>(c) < 0x20 && c != '\t' &&
+               c != '\n' && c != '\r') {
+      continue;
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
 } // namespace yabt::utils
@@ -1,18 +1,176 @@
 #include <deque>
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <map>
 #include <set>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "yabt/log/log.h"
+#include "yabt/module/lock_file.h"
 #include "yabt/module/module.h"
 #include "yabt/module/module_file.h"
+#include "yabt/utils/sha256.h"
 #include "yabt/workspace/utils.h"
 
 namespace yabt::workspace {
 
+namespace {
+
+// A dependency synced as part of a BFS level
+struct SyncItem final {
+  std::string name;
+  module::DependencyDefinition dep;
+  std::filesystem::path dir;
+  // The hash the dependency is pinned to
+  runtime::Result<std::string, std::string> result =
+      runtime::Result<std::string, std::string>::error("Not synced");
+};
+
+// Clones or fetches the dependency and checks out the revision it requires.
+// Returns the hash of that revision. Runs in a worker thread, so it must not
+// change the log indentation.
+[[nodiscard]] runtime::Result<std::string, std::string> sync_dependency(
+    const std::string &dep_name, const module::DependencyDefinition &dep,
+    const std::filesystem::path &dep_dir,
+    const std::optional<std::filesystem::path> &cache_dir) noexcept {
+  auto module = RESULT_PROPAGATE(module::open_or_fetch_module(
+      dep_dir, dep.url, dep.type, dep.hash, cache_dir));
+  if (!module->has_revisions()) {
+    // Used as it is, so there is nothing to pin either
+    return runtime::Result<std::string, std::string>::ok("");
+  }
+
+  // A pinned hash that is already in the object store needs no fetch, as long
+  // as its version is known locally too. Otherwise, the fetch brings it.
+  const bool has_hash =
+      dep.hash != "" && RESULT_PROPAGATE(module->has_revision(dep.hash));
+  if (!has_hash) {
+    RESULT_PROPAGATE_DISCARD(module->fetch());
+  }
+
+  if (dep.hash != "") {
+    const auto is_ancestor = [&]() {
+      const auto ancestor_result = module->is_ancestor(dep.hash, dep.version);
+      return ancestor_result.is_ok() && ancestor_result.ok_value();
+    };
+
+    bool hash_in_version = is_ancestor();
+    if (!hash_in_version && has_hash) {
+      yabt_debug("Version {} of {} is not known locally, fetching it",
+                 dep.version, dep_name);
+      RESULT_PROPAGATE_DISCARD(module->fetch());
+      hash_in_version = is_ancestor();
+    }
+
+    if (!hash_in_version) {
+      return runtime::Result<std::string, std::string>::error(std::format(
+          "Dependency {} has a hash: {} that is not an ancestor "
+          "of its version: {}",
+          dep_name, dep.hash, dep.version));
+    }
+  }
+
+  auto target_revision = dep.hash;
+  if (dep.hash == "") {
+    target_revision = dep.version;
+  }
+
+  // Checkout the right version of the dependency, if not current
+  if (const std::string head = RESULT_PROPAGATE(module->head());
+      head != target_revision) {
+    yabt_debug("Current head for {} is at {}. Checking out {}", dep_name, head,
+               target_revision);
+    RESULT_PROPAGATE_DISCARD(module->checkout(target_revision));
+    target_revision = RESULT_PROPAGATE(module->head());
+  }
+
+  return runtime::Result<std::string, std::string>::ok(target_revision);
+}
+
+// Calls `work` with every index in [0, count), from up to `jobs` threads
+template <typename Work>
+void run_in_parallel(const size_t count, const size_t jobs, const Work &work) {
+  std::atomic<size_t> next{0};
+  const auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      work(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(std::max<size_t>(jobs, 1), count); i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+[[nodiscard]] runtime::Result<std::string, std::string>
+hash_module_file(const std::filesystem::path &ws_root) noexcept {
+  utils::Sha256 hash;
+  RESULT_PROPAGATE_DISCARD(
+      utils::update_with_file(hash, ws_root / module::MODULE_FILE_NAME));
+  return runtime::Result<std::string, std::string>::ok(hash.hex_digest());
+}
+
+// Checks out every module of the lock file at once. The lock file is only
+// trusted while the root module file is the one it was resolved from.
+[[nodiscard]] runtime::Result<void, std::string> sync_locked_workspace(
+    const std::filesystem::path &ws_root, const size_t jobs,
+    const std::optional<std::filesystem::path> &cache_dir) noexcept {
+  const std::filesystem::path lock_path = ws_root / module::LOCK_FILE_NAME;
+  if (!std::filesystem::exists(lock_path)) {
+    return runtime::Result<void, std::string>::error(
+        std::format("No {} found in the workspace. Sync without --locked to "
+                    "generate it",
+                    module::LOCK_FILE_NAME));
+  }
+
+  const module::LockFile lock =
+      RESULT_PROPAGATE(module::LockFile::load_lock_file(lock_path));
+  if (lock.module_file_hash != RESULT_PROPAGATE(hash_module_file(ws_root))) {
+    return runtime::Result<void, std::string>::error(std::format(
+        "{} changed since {} was generated. Sync without --locked to "
+        "update it",
+        module::MODULE_FILE_NAME, module::LOCK_FILE_NAME));
+  }
+
+  std::vector<SyncItem> items;
+  for (const auto &[name, locked] : lock.modules) {
+    // The hash is its own version, so it is checked out as is
+    items.push_back(SyncItem{
+        .name{name},
+        .dep{
+            .url{locked.url},
+            .version{locked.hash},
+            .hash{locked.hash},
+            .type{locked.type},
+            .external = false,
+        },
+        .dir{ws_root / DEPS_DIR_NAME / name},
+    });
+  }
+
+  run_in_parallel(items.size(), jobs, [&items, &cache_dir](const size_t i) {
+    items[i].result = sync_dependency(items[i].name, items[i].dep,
+                                      items[i].dir, cache_dir);
+  });
+
+  for (SyncItem &item : items) {
+    const std::string hash = RESULT_PROPAGATE(std::move(item.result));
+    yabt_debug("Synced locked dependency {} at {}", item.name, hash);
+  }
+  return runtime::Result<void, std::string>::ok();
+}
+
+} // namespace
+
 [[nodiscard]] std::optional<std::filesystem::path>
 get_workspace_root() noexcept {
   std::filesystem::path cur_dir = std::filesystem::current_path();
@@ -37,104 +195,138 @@ get_workspace_root() noexcept {
 }
 
 runtime::Result<void, std::string>
-sync_workspace(std::filesystem::path ws_root,
-               const SyncMode sync_mode) noexcept {
+sync_workspace(std::filesystem::path ws_root, const SyncMode sync_mode,
+               const size_t jobs,
+               const std::optional<std::filesystem::path> &cache_dir) noexcept {
+  if (sync_mode == SyncMode::LOCKED) {
+    return sync_locked_workspace(ws_root, jobs, cache_dir);
+  }
+
   const std::filesystem::path deps_dir = ws_root / DEPS_DIR_NAME;
 
   struct PinnedMod {
     std::string hash;
+    std::string url;
+    std::string type;
   };
   std::map<std::string, PinnedMod> pinned_modules;
   std::set<std::string> handled_deps;
 
+  const auto check_pinned_hash =
+      [&pinned_modules](const std::string &dep_name,
+                        const module::DependencyDefinition &dep) {
+        const PinnedMod &pinned = pinned_modules.at(dep_name);
+        if (pinned.hash != dep.hash && dep.hash != "") {
+          return runtime::Result<void, std::string>::error(std::format(
+              "Dependency {} requires hash {}, but it has been pinned to {}",
+              dep_name, dep.hash, pinned.hash));
+        }
+        return runtime::Result<void, std::string>::ok();
+      };
+
   auto root_module = RESULT_PROPAGATE(module::open_module(ws_root));
   yabt_verbose("Found workspace root at {}", ws_root.native());
 
-  std::deque<std::filesystem::path> queue{ws_root};
-  while (queue.size() != 0) {
+  // The module graph is synced one BFS level at a time. Deciding what to sync
+  // and pinning the results happens sequentially and in BFS order, so that
+  // the outcome does not depend on which fetch finishes first. Only the
+  // fetches run concurrently.
+  std::vector<std::filesystem::path> level{ws_root};
+  while (level.size() != 0) {
     log::IndentGuard _indent_guard{};
 
-    const std::filesystem::path current_module_dir = queue.front();
-    queue.pop_front();
-
-    const std::filesystem::path modfile_path =
-        current_module_dir / module::MODULE_FILE_NAME;
-
-    const module::ModuleFile modfile =
-        RESULT_PROPAGATE(module::ModuleFile::load_module_file(modfile_path));
+    std::vector<SyncItem> items;
+    // Dependencies already being synced in this level, checked once pinned
+    std::vector<std::pair<std::string, module::DependencyDefinition>>
+        repeated_deps;
 
-    if (handled_deps.contains(modfile.name)) {
-      continue;
-    }
-    handled_deps.insert(modfile.name);
+    for (const std::filesystem::path &current_module_dir : level) {
+      const std::filesystem::path modfile_path =
+          current_module_dir / module::MODULE_FILE_NAME;
 
-    yabt_debug("Processing dependencies of {}", modfile_path.c_str());
-    log::IndentGuard _indent_guard2{};
+      const module::ModuleFile modfile =
+          RESULT_PROPAGATE(module::ModuleFile::load_module_file(modfile_path));
 
-    for (const auto &[dep_name, dep] : modfile.deps) {
-      yabt_debug("Processing {}", dep_name);
-      log::IndentGuard _indent_guard{};
-
-      const std::filesystem::path dep_dir = deps_dir / dep_name;
-      auto module = RESULT_PROPAGATE(
-          module::open_or_fetch_module(dep_dir, dep.url, dep.type, dep.hash));
-
-      if ((dep.hash == "") && (sync_mode == SyncMode::STRICT)) {
-        return runtime::Result<void, std::string>::error(std::format(
-            "Dependency {} of {} is not pinned. Refusing to sync in strict "
-            "mode.",
-            dep_name, current_module_dir.filename().native()));
+      if (handled_deps.contains(modfile.name)) {
+        continue;
       }
+      handled_deps.insert(modfile.name);
 
-      if (pinned_modules.contains(dep_name)) {
-        const PinnedMod &pinned = pinned_modules[dep_name];
-        if (pinned.hash != dep.hash && dep.hash != "") {
+      yabt_debug("Processing dependencies of {}", modfile_path.c_str());
+      log::IndentGuard _indent_guard2{};
+
+      for (const auto &[dep_name, dep] : modfile.deps) {
+        if ((dep.hash == "") && (sync_mode == SyncMode::STRICT)) {
           return runtime::Result<void, std::string>::error(std::format(
-              "Dependency {} requires hash {}, but it has been pinned to {}",
-              dep_name, dep.hash, pinned.hash));
+              "Dependency {} of {} is not pinned. Refusing to sync in strict "
+              "mode.",
+              dep_name, current_module_dir.filename().native()));
         }
-        yabt_debug("");
-        continue;
-      }
 
-      RESULT_PROPAGATE_DISCARD(module->fetch());
+        if (pinned_modules.contains(dep_name)) {
+          RESULT_PROPAGATE_DISCARD(check_pinned_hash(dep_name, dep));
+          continue;
+        }
 
-      if (dep.hash != "") {
-        const auto ancestor_result = module->is_ancestor(dep.hash, dep.version);
-        if (ancestor_result.is_error() || !ancestor_result.ok_value()) {
-          return runtime::Result<void, std::string>::error(std::format(
-              "Dependency {} has a hash: {} that is not an ancestor "
-              "of its version: {}",
-              dep_name, dep.hash, dep.version));
+        if (std::any_of(
+                items.cbegin(), items.cend(),
+                [&](const SyncItem &item) { return item.name == dep_name; })) {
+          repeated_deps.push_back(std::pair{dep_name, dep});
+          continue;
         }
-      }
 
-      auto target_revision = dep.hash;
-      if (dep.hash == "") {
-        target_revision = dep.version;
-      }
+        // Local paths of the root module stay relative to the workspace
+        // root, which keeps them portable in the lock file
+        module::DependencyDefinition synced_dep = dep;
+        if (current_module_dir != ws_root) {
+          synced_dep.url =
+              module::resolve_url(current_module_dir, dep.url, dep.type);
+        }
 
-      // Checkout the right version of the dependency, if not current
-      if (const std::string head = RESULT_PROPAGATE(module->head());
-          head != target_revision) {
-        yabt_debug("Current head for {} is at {}. Checking out {}", dep_name,
-                   head, target_revision);
-        RESULT_PROPAGATE_DISCARD(module->checkout(target_revision));
-        target_revision = RESULT_PROPAGATE(module->head());
+        yabt_debug("Syncing {}", dep_name);
+        items.push_back(SyncItem{
+            .name{dep_name},
+            .dep{std::move(synced_dep)},
+            .dir{deps_dir / dep_name},
+        });
       }
+    }
 
-      pinned_modules.insert(
-          std::pair{dep_name, PinnedMod{.hash{target_revision}}});
-      yabt_debug("Pinning dependency {} to {}", dep_name, target_revision);
-      yabt_debug("");
-
-      if (!dep.external) {
-        queue.push_back(dep_dir);
+    run_in_parallel(items.size(), jobs, [&items, &cache_dir](const size_t i) {
+      items[i].result = sync_dependency(items[i].name, items[i].dep,
+                                        items[i].dir, cache_dir);
+    });
+
+    std::vector<std::filesystem::path> next_level;
+    for (SyncItem &item : items) {
+      const std::string hash = RESULT_PROPAGATE(std::move(item.result));
+      pinned_modules.insert(std::pair{
+          item.name,
+          PinnedMod{.hash{hash}, .url{item.dep.url}, .type{item.dep.type}}});
+      yabt_debug("Pinning dependency {} to {}", item.name, hash);
+
+      if (!item.dep.external) {
+        next_level.push_back(item.dir);
       }
     }
+    for (const auto &[dep_name, dep] : repeated_deps) {
+      RESULT_PROPAGATE_DISCARD(check_pinned_hash(dep_name, dep));
+    }
+
+    level = std::move(next_level);
   }
 
-  return runtime::Result<void, std::string>::ok();
+  module::LockFile lock{
+      .version = module::LOCK_FILE_VERSION,
+      .module_file_hash{RESULT_PROPAGATE(hash_module_file(ws_root))},
+      .modules{},
+  };
+  for (const auto &[name, pinned] : pinned_modules) {
+    lock.modules.insert(std::pair{
+        name, module::LockedModule{
+                  .url{pinned.url}, .hash{pinned.hash}, .type{pinned.type}}});
+  }
+  return lock.write_lock_file(ws_root / module::LOCK_FILE_NAME);
 }
 
 runtime::Result<std::vector<std::unique_ptr<module::Module>>, std::string>